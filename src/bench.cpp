@@ -0,0 +1,815 @@
+/*
+ * This file is part of Bino, a 3D video player.
+ *
+ * Copyright (C) 2026
+ * Martin Lambers <marlam@marlam.de>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* bino-bench: measure the performance of parts of the Bino pipeline
+ * without any window, media files or audio devices, and report the
+ * results as JSON. */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+#include <new>
+#include <atomic>
+#include <algorithm>
+#include <vector>
+
+#include <QtSystemDetection>
+#ifdef Q_OS_LINUX
+# include <unistd.h>
+#endif
+#ifdef _MSC_VER
+# include <malloc.h>
+#endif
+
+#include <QGuiApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QBuffer>
+#include <QDataStream>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QSurfaceFormat>
+#include <QFile>
+#include <QDir>
+#include <QUrl>
+#include <QEventLoop>
+#include <QTimer>
+#include <QMediaDevices>
+#include <QLocalSocket>
+#include <QVector3D>
+#include <QMatrix4x4>
+
+#include "version.hpp"
+#include "log.hpp"
+#include "tools.hpp"
+#include "videoframe.hpp"
+#include "bino.hpp"
+#include "digestiblemedia.hpp"
+#include "playlist.hpp"
+#include "metadata.hpp"
+#include "commandinterpreter.hpp"
+
+
+/* Count all heap allocations so that we can report allocations per frame.
+ * With glibc, the malloc family is interposed, which also covers operator new
+ * and the allocations of Qt and the codecs. Elsewhere, only the C++ operator
+ * new overloads are counted; see allocationCounting below. */
+
+static std::atomic<long long> allocationCounter(0);
+
+#ifdef __GLIBC__
+
+static const char allocationCounting[] = "malloc";
+
+extern "C" {
+
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t n, std::size_t size);
+void* __libc_realloc(void* p, std::size_t size);
+void* __libc_memalign(std::size_t alignment, std::size_t size);
+
+void* malloc(std::size_t size)
+{
+    allocationCounter.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void* calloc(std::size_t n, std::size_t size)
+{
+    allocationCounter.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(n, size);
+}
+
+void* realloc(void* p, std::size_t size)
+{
+    allocationCounter.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(p, size);
+}
+
+void* memalign(std::size_t alignment, std::size_t size)
+{
+    allocationCounter.fetch_add(1, std::memory_order_relaxed);
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(std::size_t alignment, std::size_t size)
+{
+    return memalign(alignment, size);
+}
+
+int posix_memalign(void** p, std::size_t alignment, std::size_t size)
+{
+    if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0)
+        return EINVAL;
+    *p = memalign(alignment, size);
+    return (*p ? 0 : ENOMEM);
+}
+
+}
+
+#else
+
+static const char allocationCounting[] = "operator new";
+
+static void* countedNew(std::size_t size) noexcept
+{
+    allocationCounter.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size > 0 ? size : 1);
+}
+
+static void* countedAlignedNew(std::size_t size, std::align_val_t alignment) noexcept
+{
+    allocationCounter.fetch_add(1, std::memory_order_relaxed);
+    std::size_t a = std::max(std::size_t(alignment), sizeof(void*));
+#ifdef _MSC_VER
+    // there is no std::aligned_alloc, and the memory must be freed with _aligned_free
+    return _aligned_malloc(std::max(size, std::size_t(1)), a);
+#else
+    // std::aligned_alloc wants a multiple of the alignment
+    return std::aligned_alloc(a, (std::max(size, std::size_t(1)) + a - 1) / a * a);
+#endif
+}
+
+static void alignedFree(void* p) noexcept
+{
+#ifdef _MSC_VER
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+void* operator new(std::size_t size)
+{
+    void* p = countedNew(size);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedNew(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedNew(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    void* p = countedAlignedNew(size, alignment);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return countedAlignedNew(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return countedAlignedNew(size, alignment);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+    alignedFree(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept
+{
+    alignedFree(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept
+{
+    alignedFree(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept
+{
+    alignedFree(p);
+}
+
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    alignedFree(p);
+}
+
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    alignedFree(p);
+}
+
+#endif
+
+
+/* Timing statistics of one stage of the pipeline */
+class Stage
+{
+public:
+    std::vector<double> microseconds;
+    long long allocations = 0;
+
+    QJsonObject toJson() const
+    {
+        std::vector<double> sorted = microseconds;
+        std::sort(sorted.begin(), sorted.end());
+        double sum = 0.0;
+        for (double t : sorted)
+            sum += t;
+        auto percentile = [&](double p) {
+            return sorted.empty() ? 0.0 : sorted[size_t(p * (sorted.size() - 1) + 0.5)];
+        };
+        QJsonObject o;
+        o["frames_per_second"] = (sum > 0.0 ? sorted.size() / (sum * 1e-6) : 0.0);
+        o["latency_us_mean"] = (sorted.empty() ? 0.0 : sum / sorted.size());
+        o["latency_us_p50"] = percentile(0.50);
+        o["latency_us_p90"] = percentile(0.90);
+        o["latency_us_p99"] = percentile(0.99);
+        o["latency_us_max"] = (sorted.empty() ? 0.0 : sorted.back());
+        o["allocations_per_frame"] = (sorted.empty() ? 0.0 : double(allocations) / sorted.size());
+        return o;
+    }
+};
+
+/* The resident memory of this process in bytes, or -1 if unknown */
+static qint64 residentBytes()
+{
+#ifdef Q_OS_LINUX
+    QFile statm("/proc/self/statm");
+    if (statm.open(QIODeviceBase::ReadOnly)) {
+        QList<QByteArray> fields = statm.readAll().split(' ');
+        if (fields.size() > 1)
+            return fields[1].toLongLong() * sysconf(_SC_PAGESIZE);
+    }
+#endif
+    return -1;
+}
+
+/* The benchmarks. This class is a friend of Bino so that it can
+ * call the internal frame conversion directly. */
+class Benchmark
+{
+public:
+    static QVideoFrame syntheticFrame(QVideoFrameFormat::PixelFormat pixelFormat, int width, int height)
+    {
+        QVideoFrame frame(QVideoFrameFormat(QSize(width, height), pixelFormat));
+        if (!frame.map(QVideoFrame::WriteOnly))
+            return QVideoFrame();
+        for (int p = 0; p < frame.planeCount(); p++) {
+            uchar* bits = frame.bits(p);
+            int bpl = frame.bytesPerLine(p);
+            int rows = frame.mappedBytes(p) / bpl;
+            for (int y = 0; y < rows; y++)
+                for (int x = 0; x < bpl; x++)
+                    bits[y * qsizetype(bpl) + x] = (x + y + 64 * p) & 0xff;
+        }
+        frame.unmap();
+        return frame;
+    }
+
+    static QJsonObject frames(Bino& bino,
+            QVideoFrameFormat::PixelFormat pixelFormat, int width, int height, int frameCount)
+    {
+        QJsonObject result;
+        result["pixel_format"] = QVideoFrameFormat::pixelFormatToString(pixelFormat);
+        result["width"] = width;
+        result["height"] = height;
+        result["frames"] = frameCount;
+        QVideoFrame qframe = syntheticFrame(pixelFormat, width, height);
+        if (!qframe.isValid()) {
+            result["error"] = "cannot create frame";
+            return result;
+        }
+
+        Stage updateStage, serializeStage, uploadStage;
+        QByteArray serialized;
+        VideoFrame deserialized;
+        QElapsedTimer timer;
+        for (int i = 0; i < frameCount; i++) {
+            VideoFrame frame;
+            long long allocs = allocationCounter.load();
+            timer.start();
+            frame.update(Input_Mono, Surround_Off, qframe, false);
+            updateStage.microseconds.push_back(timer.nsecsElapsed() / 1e3);
+            updateStage.allocations += allocationCounter.load() - allocs;
+
+            allocs = allocationCounter.load();
+            timer.start();
+            {
+                QBuffer buffer(&serialized);
+                buffer.open(QIODeviceBase::WriteOnly);
+                QDataStream out(&buffer);
+                out << frame;
+            }
+            {
+                QDataStream in(serialized);
+                in >> deserialized;
+            }
+            serializeStage.microseconds.push_back(timer.nsecsElapsed() / 1e3);
+            serializeStage.allocations += allocationCounter.load() - allocs;
+
+            allocs = allocationCounter.load();
+            timer.start();
+            bino.convertFrameToTexture(frame, bino._frameTex);
+            bino.glFinish();
+            uploadStage.microseconds.push_back(timer.nsecsElapsed() / 1e3);
+            uploadStage.allocations += allocationCounter.load() - allocs;
+        }
+        QJsonObject stages;
+        stages["update"] = updateStage.toJson();
+        stages["serialize"] = serializeStage.toJson();
+        stages["upload"] = uploadStage.toJson();
+        result["stages"] = stages;
+        return result;
+    }
+
+    /* Logging: how many log checks the per-frame path executes (sink,
+     * pre-render processing, rendering of all views) and what they cost
+     * at the default log level. Checks that were removed at compile time
+     * (see BINO_LOG_LEVEL) are not counted. */
+    static QJsonObject logging(Bino& bino, int frameCount)
+    {
+        QJsonObject result;
+        result["compiled_level"] = int(LOG_COMPILED_LEVEL);
+        result["frames"] = frameCount;
+        QVideoFrame qframe = syntheticFrame(QVideoFrameFormat::Format_YUV420P, 1920, 1080);
+        if (!qframe.isValid()) {
+            result["error"] = "cannot create frame";
+            return result;
+        }
+        unsigned int viewTex;
+        bino.glGenTextures(1, &viewTex);
+        int viewTexWidth = 0, viewTexHeight = 0;
+        auto renderFrame = [&]() {
+            bino._videoSink->processNewFrame(qframe);
+            int viewCount, viewWidth, viewHeight;
+            bino.preRenderProcess(1920, 1080, &viewCount, &viewWidth, &viewHeight);
+            bino.glBindTexture(GL_TEXTURE_2D, viewTex);
+            if (viewTexWidth != viewWidth || viewTexHeight != viewHeight) {
+                bino.glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, viewWidth, viewHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+                viewTexWidth = viewWidth;
+                viewTexHeight = viewHeight;
+            }
+            for (int v = 0; v < viewCount; v++) {
+                bino.render(QVector3D(), QVector3D(), QVector3D(), QVector3D(), QVector3D(), QVector3D(),
+                        QMatrix4x4(), QMatrix4x4(), QMatrix4x4(), v, viewWidth, viewHeight, viewTex);
+            }
+            bino.glFinish();
+        };
+
+        // Count the checks by enabling all levels; every check then logs one line
+        QString logFileName = QDir::temp().filePath("bino-bench-log.txt");
+        SetLogFile(qPrintable(logFileName), true);
+        LogLevel logLevel = GetLogLevel();
+        SetLogLevel(Log_Level_Firehose);
+        renderFrame(); // first frame initializes textures etc.
+        unsigned long long lines = GetLogLineCount();
+        for (int i = 0; i < frameCount; i++)
+            renderFrame();
+        double checksPerFrame = double(GetLogLineCount() - lines) / frameCount;
+        SetLogLevel(logLevel);
+        LogFlush();
+        SetLogFile(nullptr, false);
+        QFile::remove(logFileName);
+
+        // The cost of one check that fails at runtime, with arguments like
+        // those in the hot paths. The fence keeps the compiler from hoisting
+        // the level check out of the loop.
+        const int checkCount = 10000000;
+        QString arg = "argument";
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < checkCount; i++) {
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+            LOG_FIREHOSE("check %d: %s", i, qPrintable(arg));
+        }
+        double nanosecondsPerCheck = double(timer.nsecsElapsed()) / checkCount;
+
+        // The whole frame at the default log level, for comparison
+        Stage frameStage;
+        for (int i = 0; i < frameCount; i++) {
+            long long allocs = allocationCounter.load();
+            timer.start();
+            renderFrame();
+            frameStage.microseconds.push_back(timer.nsecsElapsed() / 1e3);
+            frameStage.allocations += allocationCounter.load() - allocs;
+        }
+        bino.glDeleteTextures(1, &viewTex);
+
+        result["checks_per_frame"] = checksPerFrame;
+        result["check_ns"] = nanosecondsPerCheck;
+        result["check_overhead_us_per_frame"] = checksPerFrame * nanosecondsPerCheck / 1e3;
+        result["frame"] = frameStage.toJson();
+        return result;
+    }
+
+    /* Still images: opening (reading or mapping) and decoding local files */
+    static QJsonObject images(const QStringList& files, bool mapped)
+    {
+        QJsonObject result;
+        result["mapped"] = mapped;
+        result["images"] = int(files.size());
+        Stage openStage, decodeStage;
+        qint64 residentIncreaseMax = -1;
+        QElapsedTimer timer;
+        for (const QString& fileName : files) {
+            QUrl url = QUrl::fromLocalFile(fileName);
+            qint64 resident = residentBytes();
+            long long allocs = allocationCounter.load();
+            timer.start();
+            QFile file(fileName);
+            QByteArray data;
+            if (mapped)
+                data = mapFile(file);
+            else if (file.open(QIODeviceBase::ReadOnly))
+                data = file.readAll();
+            openStage.microseconds.push_back(timer.nsecsElapsed() / 1e3);
+            openStage.allocations += allocationCounter.load() - allocs;
+            if (resident >= 0)
+                residentIncreaseMax = std::max(residentIncreaseMax, residentBytes() - resident);
+            if (data.isEmpty()) {
+                result["error"] = QString("cannot open %1").arg(fileName);
+                return result;
+            }
+
+            allocs = allocationCounter.load();
+            timer.start();
+            QImage img = decodeStillImage(url, data);
+            decodeStage.microseconds.push_back(timer.nsecsElapsed() / 1e3);
+            decodeStage.allocations += allocationCounter.load() - allocs;
+            if (img.isNull()) {
+                result["error"] = QString("cannot decode %1").arg(fileName);
+                return result;
+            }
+        }
+        // the increase of resident memory caused by opening a file, before decoding
+        result["open_resident_increase_kib_max"] = (residentIncreaseMax < 0 ? -1.0 : residentIncreaseMax / 1024.0);
+        QJsonObject stages;
+        stages["open"] = openStage.toJson();
+        stages["decode"] = decodeStage.toJson();
+        result["stages"] = stages;
+        return result;
+    }
+
+    /* Playlist transitions: the time from the end of one entry to the
+     * first frame of the next one, with or without prerolling */
+    static QJsonObject transitions(Bino& bino, const QStringList& files, int transitionCount, bool preroll)
+    {
+        QJsonObject result;
+        result["preroll"] = preroll;
+        result["transitions"] = transitionCount;
+        Playlist* playlist = Playlist::instance();
+        playlist->stop();
+        playlist->clear();
+        for (const QString& file : files)
+            playlist->append(PlaylistEntry(QUrl::fromUserInput(file, QDir::currentPath(), QUrl::AssumeLocalFile)));
+        playlist->setLoopMode(Loop_All);
+        playlist->setWaitMode(Wait_Off);
+        bino.setPrerollNext(preroll);
+
+        Stage gapStage;
+        int seen = -1; // the start of the first entry is not a transition
+        QEventLoop loop;
+        QTimer timeout;
+        timeout.setSingleShot(true);
+        QObject::connect(&timeout, &QTimer::timeout, &loop, &QEventLoop::quit);
+        QMetaObject::Connection connection = QObject::connect(&bino, &Bino::mediaTransitionDone,
+                [&](double milliseconds) {
+                if (seen >= 0)
+                    gapStage.microseconds.push_back(milliseconds * 1e3);
+                seen++;
+                if (seen >= transitionCount)
+                    loop.quit();
+                else
+                    timeout.start(60000);
+                });
+        timeout.start(60000);
+        bino.startPlaylistMode();
+        if (seen < transitionCount)
+            loop.exec();
+        QObject::disconnect(connection);
+        playlist->stop();
+        if (seen < transitionCount)
+            result["error"] = "timeout";
+        result["gap"] = gapStage.toJson();
+        return result;
+    }
+
+    /* Remote command latency: the time from writing a command to the
+     * command interpreter's local socket until it is processed, for single
+     * commands and for a burst of commands written at once */
+    static QJsonObject commandLatency(CommandInterpreter& cmdInterpreter, int commandCount)
+    {
+        QJsonObject result;
+        result["commands"] = commandCount;
+        QString name = QString("bino-bench-%1").arg(QCoreApplication::applicationPid());
+        if (!cmdInterpreter.init(CommandInterpreter::Type_LocalSocket, name)) {
+            result["error"] = "cannot listen";
+            return result;
+        }
+        cmdInterpreter.start();
+        QLocalSocket client;
+        client.connectToServer(name);
+        if (!client.waitForConnected(5000)) {
+            result["error"] = "cannot connect";
+            return result;
+        }
+
+        int processed = 0;
+        int expected = 0;
+        QEventLoop loop;
+        QTimer timeout;
+        timeout.setSingleShot(true);
+        QObject::connect(&timeout, &QTimer::timeout, &loop, &QEventLoop::quit);
+        QMetaObject::Connection connection = QObject::connect(&cmdInterpreter, &CommandInterpreter::commandProcessed,
+                [&]() {
+                processed++;
+                if (processed >= expected)
+                    loop.quit();
+                });
+        auto roundTrip = [&](const QByteArray& commands, int count) -> qint64 {
+            processed = 0;
+            expected = count;
+            QElapsedTimer timer;
+            timer.start();
+            client.write(commands);
+            client.flush();
+            timeout.start(10000);
+            loop.exec();
+            timeout.stop();
+            return (processed >= expected ? timer.nsecsElapsed() : -1);
+        };
+
+        Stage singleStage, burstStage;
+        for (int i = 0; i < commandCount; i++) {
+            qint64 ns = roundTrip("# latency\n", 1);
+            if (ns < 0) {
+                result["error"] = "timeout";
+                break;
+            }
+            singleStage.microseconds.push_back(ns / 1e3);
+        }
+        QByteArray burst;
+        for (int i = 0; i < commandCount; i++)
+            burst.append("# latency\n");
+        qint64 ns = roundTrip(burst, commandCount);
+        if (ns < 0)
+            result["error"] = "timeout";
+        else
+            burstStage.microseconds.push_back(ns / 1e3);
+        QObject::disconnect(connection);
+        client.disconnectFromServer();
+        result["single"] = singleStage.toJson();
+        result["burst"] = burstStage.toJson();
+        return result;
+    }
+};
+
+
+int main(int argc, char* argv[])
+{
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+    QGuiApplication::setApplicationName("bino-bench");
+    QGuiApplication::setApplicationVersion(BINO_VERSION);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Bino benchmarks -- results are written as JSON");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addOption({ "frames", "Number of frames per test (default 30).", "n" });
+    parser.addOption({ "sizes", "Comma-separated list of frame sizes (default 1920x1080,3840x2160,7680x4320).", "list" });
+    parser.addOption({ "opengles", "Use OpenGL ES instead of Desktop OpenGL." });
+    parser.addOption({ "output", "Write the results to this file instead of stdout.", "file" });
+    parser.addOption({ "transitions", "Measure playlist transition gaps with this comma-separated list of (short) media files.", "list" });
+    parser.addOption({ "transition-count", "Number of playlist transitions to measure (default 10).", "n" });
+    parser.addOption({ "images", "Measure opening and decoding of this comma-separated list of local image files (e.g. MPO, JPS).", "list" });
+    parser.addOption({ "command-latency", "Measure the latency of this number of remote commands sent via a local socket.", "n" });
+    parser.addOption({ "logging", "Measure the per-frame overhead of log level checks." });
+    parser.process(app);
+
+    SetLogLevel(Log_Level_Warning);
+    int frameCount = 30;
+    if (parser.isSet("frames")) {
+        bool ok;
+        frameCount = parser.value("frames").toInt(&ok);
+        if (!ok || frameCount < 1) {
+            LOG_FATAL("Invalid argument for option --frames");
+            return 1;
+        }
+    }
+    int transitionCount = 10;
+    if (parser.isSet("transition-count")) {
+        bool ok;
+        transitionCount = parser.value("transition-count").toInt(&ok);
+        if (!ok || transitionCount < 1) {
+            LOG_FATAL("Invalid argument for option --transition-count");
+            return 1;
+        }
+    }
+    int commandCount = 0;
+    if (parser.isSet("command-latency")) {
+        bool ok;
+        commandCount = parser.value("command-latency").toInt(&ok);
+        if (!ok || commandCount < 1) {
+            LOG_FATAL("Invalid argument for option --command-latency");
+            return 1;
+        }
+    }
+    QList<QSize> sizes = { QSize(1920, 1080), QSize(3840, 2160), QSize(7680, 4320) };
+    if (parser.isSet("sizes")) {
+        sizes.clear();
+        for (const QString& s : parser.value("sizes").split(',')) {
+            int w, h;
+            if (2 != std::sscanf(qPrintable(s), "%dx%d", &w, &h) || w < 2 || h < 2) {
+                LOG_FATAL("Invalid argument for option --sizes");
+                return 1;
+            }
+            sizes.append(QSize(w, h));
+        }
+    }
+
+    // Set up an offscreen OpenGL context just like main() does for a window
+    QSurfaceFormat format;
+    if (parser.isSet("opengles"))
+        format.setRenderableType(QSurfaceFormat::OpenGLES);
+    initializeOpenGLType(format);
+    if (OpenGLType == OpenGL_Type_OpenGLES) {
+        format.setVersion(3, 1);
+    } else {
+        format.setProfile(QSurfaceFormat::CoreProfile);
+        format.setVersion(3, 3);
+    }
+    QSurfaceFormat::setDefaultFormat(format);
+    QOffscreenSurface surface;
+    surface.setFormat(format);
+    surface.create();
+    QOpenGLContext context;
+    context.setFormat(format);
+    if (!context.create() || !context.makeCurrent(&surface)) {
+        LOG_FATAL("Cannot create offscreen OpenGL context");
+        return 1;
+    }
+    Playlist playlist;
+    MetaDataPrefetcher metaDataPrefetcher;
+    CommandInterpreter cmdInterpreter;
+    Bino bino(Bino::ScreenGeometry, Screen(), false);
+    bino.initializeOutput(QMediaDevices::defaultAudioOutput());
+    if (!bino.initProcess())
+        return 1;
+
+    const QList<QVideoFrameFormat::PixelFormat> pixelFormats = {
+        QVideoFrameFormat::Format_ARGB8888,
+        QVideoFrameFormat::Format_ARGB8888_Premultiplied,
+        QVideoFrameFormat::Format_XRGB8888,
+        QVideoFrameFormat::Format_BGRA8888,
+        QVideoFrameFormat::Format_BGRA8888_Premultiplied,
+        QVideoFrameFormat::Format_BGRX8888,
+        QVideoFrameFormat::Format_ABGR8888,
+        QVideoFrameFormat::Format_XBGR8888,
+        QVideoFrameFormat::Format_RGBA8888,
+        QVideoFrameFormat::Format_RGBX8888,
+        QVideoFrameFormat::Format_YUV420P,
+        QVideoFrameFormat::Format_YUV422P,
+        QVideoFrameFormat::Format_YV12,
+        QVideoFrameFormat::Format_NV12,
+        QVideoFrameFormat::Format_P010,
+        QVideoFrameFormat::Format_P016,
+        QVideoFrameFormat::Format_Y8,
+        QVideoFrameFormat::Format_Y16
+    };
+    QJsonArray frameResults;
+    for (const QSize& size : sizes) {
+        for (QVideoFrameFormat::PixelFormat pixelFormat : pixelFormats) {
+            LOG_INFO("frames: %s %dx%d", qPrintable(QVideoFrameFormat::pixelFormatToString(pixelFormat)),
+                    size.width(), size.height());
+            frameResults.append(Benchmark::frames(bino, pixelFormat, size.width(), size.height(), frameCount));
+        }
+    }
+
+    QJsonArray transitionResults;
+    if (parser.isSet("transitions")) {
+        QStringList files = parser.value("transitions").split(',');
+        for (bool preroll : { true, false }) {
+            LOG_INFO("transitions: preroll %s", preroll ? "on" : "off");
+            transitionResults.append(Benchmark::transitions(bino, files, transitionCount, preroll));
+        }
+    }
+
+    QJsonArray imageResults;
+    if (parser.isSet("images")) {
+        QStringList files = parser.value("images").split(',');
+        for (bool mapped : { false, true }) {
+            LOG_INFO("images: %s", mapped ? "mapped" : "read");
+            imageResults.append(Benchmark::images(files, mapped));
+        }
+    }
+
+    QJsonObject commandLatencyResult;
+    if (commandCount > 0) {
+        LOG_INFO("command latency: %d commands", commandCount);
+        commandLatencyResult = Benchmark::commandLatency(cmdInterpreter, commandCount);
+    }
+
+    QJsonObject loggingResult;
+    if (parser.isSet("logging")) {
+        LOG_INFO("logging");
+        loggingResult = Benchmark::logging(bino, frameCount);
+    }
+
+    QJsonObject root;
+    root["bino_version"] = BINO_VERSION;
+    root["qt_version"] = qVersion();
+    root["opengl_renderer"] = getOpenGLString(context.extraFunctions(), GL_RENDERER);
+    root["allocation_counting"] = allocationCounting;
+    root["frames"] = frameResults;
+    if (parser.isSet("transitions"))
+        root["transitions"] = transitionResults;
+    if (parser.isSet("images"))
+        root["images"] = imageResults;
+    if (commandCount > 0)
+        root["command_latency"] = commandLatencyResult;
+    if (parser.isSet("logging"))
+        root["logging"] = loggingResult;
+    QByteArray json = QJsonDocument(root).toJson();
+    QFile out;
+    bool ok;
+    if (parser.isSet("output")) {
+        out.setFileName(parser.value("output"));
+        ok = out.open(QIODeviceBase::WriteOnly | QIODeviceBase::Truncate);
+    } else {
+        ok = out.open(stdout, QIODeviceBase::WriteOnly);
+    }
+    if (!ok || out.write(json) != json.size()) {
+        LOG_FATAL("Cannot write results: %s", qPrintable(out.errorString()));
+        return 1;
+    }
+    return 0;
+}
@@ -18,12 +18,20 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
 #include <QDateTime>
+#include <QtMath>
+#include <QVector2D>
+#include <QVector4D>
 
 #include "bino.hpp"
 #include "log.hpp"
+#include "trace.hpp"
 #include "tools.hpp"
-#include "digestiblemedia.hpp"
 #include "metadata.hpp"
 #include "commandinterpreter.hpp"
 
@@ -35,6 +43,16 @@ Bino::Bino(ScreenType screenType, const Screen& screen, bool swapEyes) :
     _videoSink(nullptr),
     _audioOutput(nullptr),
     _player(nullptr),
+    _playerIgnoreNextStop(false),
+    _imageSource(nullptr),
+    _switchState(Switch_Idle),
+    _ownMetaDataPrefetcher(nullptr),
+    _prerollNext(true),
+    _nextPlayer(nullptr),
+    _nextVideoSink(nullptr),
+    _nextPlayerIndex(-1),
+    _nextPlayerWaitingForMetaData(false),
+    _nextPlayerReady(false),
     _audioInput(nullptr),
     _videoInput(nullptr),
     _screenInput(nullptr),
@@ -47,13 +65,31 @@ Bino::Bino(ScreenType screenType, const Screen& screen, bool swapEyes) :
     _lastFrameSurroundMode(Surround_Unknown),
     _screenType(screenType),
     _screen(screen),
+    _maxTextureSize(std::numeric_limits<int>::max()), // known after initProcess()
+    _maxArrayTextureLayers(std::numeric_limits<int>::max()), // known after initProcess()
+    _tileSize(4096),
     _frameIsNew(true),
+    _spareFrameIsNew(false),
+    _frameIsTiled(false),
+    _tileColumns(0),
+    _tileRows(0),
+    _tileStride(0),
+    _tileLod(-1),
+    _tileConversionBudget(10),
+    _lastVerticalFOV(90.0f),
     _frameWasSerialized(true),
+    _newFrameTime(-1),
     _swapEyes(swapEyes),
     _overlayUIShow(false)
 {
     Q_ASSERT(!binoSingleton);
     binoSingleton = this;
+    _switchTimer.setSingleShot(true);
+    connect(&_switchTimer, &QTimer::timeout, [=]() { switchTimeout(); });
+    // Media switches and prerolling wait for the prefetcher instead of
+    // detecting meta data synchronously, so there must always be one.
+    if (!MetaDataPrefetcher::instance())
+        _ownMetaDataPrefetcher = new MetaDataPrefetcher;
 }
 
 Bino::~Bino()
@@ -61,11 +97,15 @@ Bino::~Bino()
     delete _videoSink;
     delete _audioOutput;
     delete _player;
+    delete _imageSource;
+    delete _nextPlayer;
+    delete _nextVideoSink;
     delete _audioInput;
     delete _videoInput;
     delete _screenInput;
     delete _windowInput;
     delete _captureSession;
+    delete _ownMetaDataPrefetcher;
     binoSingleton = nullptr;
 }
 
@@ -77,10 +117,49 @@ Bino* Bino::instance()
 void Bino::initializeOutput(const QAudioDevice& audioOutputDevice)
 {
     _videoSink = new VideoSink(&_frame, &_extFrame, &_frameIsNew);
-    connect(_videoSink, &VideoSink::newVideoFrame, [=]() { emit newVideoFrame(); });
+    connect(_videoSink, &VideoSink::newVideoFrameTime, [=](qint64 microseconds) { _newFrameTime = microseconds; });
+    connect(_videoSink, &VideoSink::newVideoFrame, [=]() {
+            if (_newFrameTime < 0) {
+                emit newVideoFrame();
+                return;
+            }
+            // Listeners of the frame time, e.g. scheduled commands, may change any
+            // state, so they run from the event loop, and before the frame is rendered.
+            qint64 frameTime = _newFrameTime;
+            _newFrameTime = -1;
+            QMetaObject::invokeMethod(this, [=]() {
+                    emit newVideoFrameTime(frameTime);
+                    emit newVideoFrame();
+                    }, Qt::QueuedConnection);
+            });
     connect(_videoSink, &VideoSink::newVideoFrame, [=]() { _frameWasSerialized = false; });
+    connect(_videoSink, &VideoSink::newVideoFrame, [=]() { _frameStatistics.framesReceived++; });
+    connect(_videoSink, &VideoSink::newVideoFrame, [=]() {
+            if (_transitionTimer.isValid()) {
+                double ms = _transitionTimer.nsecsElapsed() / 1e6;
+                _transitionTimer.invalidate();
+                LOG_DEBUG("playlist transition took %.1f ms", ms);
+                emit mediaTransitionDone(ms);
+            }
+            });
     _audioOutput = new QAudioOutput;
     _audioOutput->setDevice(audioOutputDevice);
+    _imageSource = new ImageSource;
+    _imageSource->setVideoSink(_videoSink);
+    connect(_imageSource, &ImageSource::frameReady, [=]() {
+            if (_switchState == Switch_Opening)
+                switchOpened();
+            });
+    connect(_imageSource, &ImageSource::errorOccurred, [=](const QString& errorString) {
+            LOG_WARNING("%s", qPrintable(errorString));
+            if (_switchState == Switch_Opening)
+                switchFailed();
+            });
+    connect(_imageSource, &ImageSource::ended, [=]() {
+            Playlist::instance()->mediaEnded();
+            });
+    connect(_imageSource, &ImageSource::stateChanged, [=]() { emit stateChanged(); });
+    connect(_imageSource, &ImageSource::prefetched, [=]() { updateSpareFrame(); });
 }
 
 void Bino::startPlaylistMode()
@@ -104,21 +183,114 @@ void Bino::startPlaylistMode()
 
     connect(Playlist::instance(), SIGNAL(mediaChanged(PlaylistEntry)), this, SLOT(mediaChanged(PlaylistEntry)));
 
-    _playerAvailable = false;
-    _playerFailure = false;
+    connect(MetaDataPrefetcher::instance(), &MetaDataPrefetcher::finished, this,
+            [=](const QUrl& url) {
+            if (_switchState == Switch_MetaData && url == _switchEntry.url) {
+                _switchMetaData.detectFromCache(url); // stays empty if detection failed
+                switchMetaDataReady();
+            }
+            if (_nextPlayer && _nextPlayerWaitingForMetaData && url == _nextPlayerEntry.url) {
+                _nextPlayerWaitingForMetaData = false;
+                if (_nextPlayerMetaData.detectFromCache(url))
+                    nextPlayerMetaDataReady();
+                else
+                    discardNextPlayer(); // the regular switch will report the problem
+            }
+            });
     _playerIgnoreNextStop = false;
-    _player = new QMediaPlayer;
+    _player = createPlayer();
     _player->setVideoOutput(_videoSink);
     _player->setAudioOutput(_audioOutput);
-    _player->connect(_player, &QMediaPlayer::metaDataChanged,
-            [&]() { _playerAvailable = true; });
-    _player->connect(_player, &QMediaPlayer::errorOccurred,
+    if (Playlist::instance()->length() > 0) {
+        Playlist::instance()->start();
+    } else {
+        emit stateChanged();
+    }
+}
+
+void Bino::setPrerollNext(bool preroll)
+{
+    _prerollNext = preroll;
+    if (!_prerollNext)
+        discardNextPlayer();
+}
+
+void Bino::setSlideshowDuration(int milliseconds)
+{
+    _imageSource->setDuration(milliseconds);
+}
+
+void Bino::setTileConversionBudget(int milliseconds)
+{
+    _tileConversionBudget = milliseconds;
+}
+
+bool Bino::showingImage() const
+{
+    return !_imageSource->source().isEmpty();
+}
+
+/* For slideshows, the current and the next few images are decoded in parallel
+ * ahead of time, and the next image is uploaded into a spare texture while the
+ * current one is shown. */
+
+void Bino::prefetchImages()
+{
+    const Playlist* playlist = Playlist::instance();
+    QList<QUrl> urls;
+    for (int n = 0; n <= 3; n++) {
+        int index = (n == 0 ? playlist->currentIndex() : playlist->upcomingIndex(n));
+        if (index < 0)
+            break;
+        urls.append(playlist->entries()[index].url);
+    }
+    _imageSource->prefetch(urls);
+}
+
+void Bino::updateSpareFrame()
+{
+    const Playlist* playlist = Playlist::instance();
+    int index = playlist->upcomingIndex(1);
+    QVideoFrame frame;
+    if (index >= 0)
+        frame = _imageSource->cachedFrame(playlist->entries()[index].url);
+    if (!frame.isValid() || frame == _spareFrame.qframe)
+        return;
+    if (frame.width() > _maxTextureSize || frame.height() > _maxTextureSize)
+        return; // needs tiles, which exist only for the current frame
+    LOG_DEBUG("preparing spare frame for %s", qPrintable(playlist->entries()[index].url.toString()));
+    _spareFrame.update(Input_Mono, Surround_Off, frame, false);
+    _spareFrameIsNew = true;
+    emit renderRequested();
+}
+
+QMediaPlayer* Bino::createPlayer()
+{
+    // The signal handlers check which role the player currently has,
+    // since the player of the next entry becomes the main player on transitions.
+    QMediaPlayer* player = new QMediaPlayer;
+    player->connect(player, &QMediaPlayer::metaDataChanged,
+            [=]() {
+            if (player == _player && _switchState == Switch_Opening)
+                switchOpened();
+            else if (player == _nextPlayer)
+                nextPlayerAvailable();
+            });
+    player->connect(player, &QMediaPlayer::errorOccurred,
             [=](QMediaPlayer::Error /* error */, const QString& errorString) {
-            _playerFailure = true;
-            LOG_WARNING("%s", qPrintable(tr("Media player error: %1").arg(errorString)));
+            if (player == _player) {
+                LOG_WARNING("%s", qPrintable(tr("Media player error: %1").arg(errorString)));
+                if (_switchState == Switch_Opening)
+                    switchFailed();
+            } else if (player == _nextPlayer) {
+                LOG_DEBUG("cannot preroll next playlist entry: %s", qPrintable(errorString));
+                discardNextPlayer();
+            }
             });
-    _player->connect(_player, &QMediaPlayer::playbackStateChanged,
+    player->connect(player, &QMediaPlayer::playbackStateChanged,
             [=](QMediaPlayer::PlaybackState state) {
+            if (player != _player)
+                return;
             LOG_DEBUG("Playback state changed to %s",
                     state == QMediaPlayer::StoppedState ? "stopped"
                     : state == QMediaPlayer::PlayingState ? "playing"
@@ -127,18 +299,159 @@ void Bino::startPlaylistMode()
             if (state == QMediaPlayer::StoppedState) {
                 if (_playerIgnoreNextStop) {
                     _playerIgnoreNextStop = false;
+                    if (_switchState == Switch_Stopping)
+                        switchStopped();
                 } else {
                     Playlist::instance()->mediaEnded();
                 }
             }
             });
-    if (Playlist::instance()->length() > 0) {
-        Playlist::instance()->start();
+    return player;
+}
+
+void Bino::selectTracks(QMediaPlayer* player, const PlaylistEntry& entry, const MetaData& metaData)
+{
+    if (!metaData.videoTracks.isEmpty() && entry.videoTrack >= 0) {
+        player->setActiveVideoTrack(entry.videoTrack);
+    }
+    if (entry.audioTrack >= 0) {
+        player->setActiveAudioTrack(entry.audioTrack);
+    } else if (Playlist::instance()->preferredAudio() != QLocale::AnyLanguage) {
+        int audioTrack = -1;
+        for (int i = 0; i < int(metaData.audioTracks.length()); i++) {
+            QLocale audioLanguage = metaData.audioTracks[i].value(QMediaMetaData::Language).toLocale();
+            if (audioLanguage == Playlist::instance()->preferredAudio()) {
+                audioTrack = i;
+                break;
+            }
+        }
+        if (audioTrack >= 0) {
+            player->setActiveAudioTrack(entry.audioTrack);
+        }
+    }
+    if (entry.subtitleTrack >= 0) {
+        player->setActiveSubtitleTrack(entry.subtitleTrack);
+    } else if (entry.subtitleTrack == PlaylistEntry::NoTrack) {
+        // do nothing
+    } else if (metaData.subtitleTracks.size() > 0 && Playlist::instance()->wantSubtitle()) {
+        int subtitleTrack = 0;
+        for (int i = 0; i < int(metaData.subtitleTracks.length()); i++) {
+            QLocale subtitleLanguage = metaData.subtitleTracks[i].value(QMediaMetaData::Language).toLocale();
+            if (subtitleLanguage == Playlist::instance()->preferredSubtitle()) {
+                subtitleTrack = i;
+                break;
+            }
+        }
+        player->setActiveSubtitleTrack(subtitleTrack);
+    }
+}
+
+void Bino::prerollNextPlayer()
+{
+    const Playlist* playlist = Playlist::instance();
+    int index = playlist->upcomingIndex(1);
+    if (!_prerollNext || playlist->waitMode() != Wait_Off || index < 0)
+        return;
+    const PlaylistEntry& entry = playlist->entries()[index];
+    if (entry.noMedia() || ImageSource::handles(entry.url)) // images do not need a player
+        return;
+    LOG_DEBUG("prerolling next playlist entry %s", qPrintable(entry.url.toString()));
+    _nextPlayerIndex = index;
+    _nextPlayerEntry = entry;
+    _nextPlayerMetaData = MetaData();
+    _nextPlayerWaitingForMetaData = false;
+    _nextPlayerFirstFrame = QVideoFrame();
+    _nextPlayerReady = false;
+    // The next player decodes into its own sink until it is swapped in, and it has no audio output.
+    _nextVideoSink = new QVideoSink;
+    _nextVideoSink->connect(_nextVideoSink, &QVideoSink::videoFrameChanged,
+            [=](const QVideoFrame& frame) {
+            if (frame.isValid() && !_nextPlayerReady) {
+                _nextPlayerFirstFrame = frame;
+                _nextPlayerReady = true;
+                LOG_DEBUG("next playlist entry is ready");
+            }
+            });
+    _nextPlayer = createPlayer();
+    _nextPlayer->setVideoOutput(_nextVideoSink);
+    _nextPlayer->setSource(entry.url);
+}
+
+void Bino::nextPlayerAvailable()
+{
+    if (_nextPlayer->playbackState() != QMediaPlayer::StoppedState // already prerolling
+            || _nextPlayerWaitingForMetaData)
+        return;
+    // Meta data is usually cached by now; otherwise wait for the prefetcher
+    // instead of blocking inside this signal handler.
+    if (_nextPlayerMetaData.detectFromCache(_nextPlayerEntry.url)) {
+        nextPlayerMetaDataReady();
     } else {
-        emit stateChanged();
+        _nextPlayerWaitingForMetaData = true;
+        MetaDataPrefetcher::instance()->request(_nextPlayerEntry.url);
     }
 }
 
+void Bino::nextPlayerMetaDataReady()
+{
+    selectTracks(_nextPlayer, _nextPlayerEntry, _nextPlayerMetaData);
+    // pausing a stopped player decodes and presents its first frame
+    _nextPlayer->pause();
+    if (_nextPlayerMetaData.videoTracks.isEmpty())
+        _nextPlayerReady = true;
+}
+
+void Bino::discardNextPlayer()
+{
+    if (!_nextPlayer)
+        return;
+    // we might be called from a signal of this player, so do not delete it directly
+    _nextPlayer->disconnect();
+    _nextPlayer->setVideoOutput(nullptr);
+    _nextPlayer->deleteLater();
+    _nextPlayer = nullptr;
+    _nextVideoSink->disconnect();
+    _nextVideoSink->deleteLater();
+    _nextVideoSink = nullptr;
+    _nextPlayerIndex = -1;
+    _nextPlayerWaitingForMetaData = false;
+    _nextPlayerFirstFrame = QVideoFrame();
+    _nextPlayerReady = false;
+}
+
+void Bino::swapInNextPlayer(const PlaylistEntry& entry)
+{
+    LOG_DEBUG("swapping in prerolled player for %s", qPrintable(entry.url.toString()));
+    QMediaPlayer* oldPlayer = _player;
+    // detach the old player first so that the last frame stays visible until the new one arrives
+    oldPlayer->setVideoOutput(nullptr);
+    oldPlayer->setAudioOutput(nullptr);
+    _player = _nextPlayer;
+    _nextPlayer = nullptr;
+    QVideoFrame firstFrame = _nextPlayerFirstFrame;
+    MetaData metaData = _nextPlayerMetaData;
+    _nextVideoSink->disconnect();
+    _nextVideoSink->deleteLater();
+    _nextVideoSink = nullptr;
+    _nextPlayerIndex = -1;
+    _nextPlayerWaitingForMetaData = false;
+    _nextPlayerFirstFrame = QVideoFrame();
+    _nextPlayerReady = false;
+
+    _playerIgnoreNextStop = false;
+    _player->setVideoOutput(_videoSink);
+    _player->setAudioOutput(_audioOutput);
+    if (metaData.videoTracks.isEmpty())
+        _overlayAudio.updateParameters(metaData);
+    _videoSink->newPlaylistEntry(entry, metaData);
+    if (firstFrame.isValid())
+        _videoSink->processNewFrame(firstFrame);
+    _player->play();
+    // we might be called from a signal of the old player, so do not delete it directly
+    oldPlayer->disconnect();
+    oldPlayer->deleteLater();
+}
+
 void Bino::startCaptureMode(bool withAudioInput, const QAudioDevice& audioInputDevice, InputMode inputMode)
 {
     if (playlistMode())
@@ -252,73 +565,134 @@ const QWindowCapture* Bino::captureModeWindowInput() const
     return _windowInput;
 }
 
+/* Switching to a new playlist entry does not block: it is a small state machine
+ * (stopping -> meta data -> opening -> playing) that is driven by the signals of
+ * the media player and the meta data prefetcher. Each state has a timeout.
+ * A new call to mediaChanged() while a switch is in progress cancels that switch. */
+
 void Bino::mediaChanged(PlaylistEntry entry)
 {
     if (!playlistMode())
         return;
-    _playerIgnoreNextStop = true;
-    _player->setSource(QUrl());
-    while (_player->playbackState() != QMediaPlayer::StoppedState) {
-        QGuiApplication::processEvents();
+    _transitionTimer.start();
+    if (_switchState != Switch_Idle)
+        LOG_DEBUG("media switch to %s cancelled", qPrintable(_switchEntry.url.toString()));
+    setSwitchState(Switch_Idle);
+    _imageSource->setSource(QUrl());
+    prefetchImages();
+    if (!entry.noMedia() && _nextPlayer && _nextPlayerReady
+            && _nextPlayerIndex == Playlist::instance()->currentIndex()
+            && _nextPlayerEntry.url == entry.url
+            && _nextPlayerEntry.optionsToString() == entry.optionsToString()) {
+        swapInNextPlayer(entry);
+        prerollNextPlayer();
+        emit stateChanged();
+        return;
     }
-    _playerIgnoreNextStop = false;
-    if (!entry.noMedia()) {
-        // Get meta data
-        MetaData metaData;
-        metaData.detectCached(entry.url);
-        // Special handling of files that cannot be digested by QtMultimedia directly
-        QUrl digestibleUrl = digestibleMediaUrl(entry.url);
-        // Set new source
-        _playerAvailable = false;
-        _playerFailure = false;
-        _player->setSource(digestibleUrl);
-        do {
-            QGuiApplication::processEvents();
-        }
-        while (!_playerFailure && !_playerAvailable);
-        if (_playerFailure)
-            return;
-        if (metaData.videoTracks.isEmpty()) {
-            _overlayAudio.updateParameters(metaData);
-        } else if (entry.videoTrack >= 0) {
-            _player->setActiveVideoTrack(entry.videoTrack);
-        }
-        if (entry.audioTrack >= 0) {
-            _player->setActiveAudioTrack(entry.audioTrack);
-        } else if (Playlist::instance()->preferredAudio() != QLocale::AnyLanguage) {
-            int audioTrack = -1;
-            for (int i = 0; i < int(metaData.audioTracks.length()); i++) {
-                QLocale audioLanguage = metaData.audioTracks[i].value(QMediaMetaData::Language).toLocale();
-                if (audioLanguage == Playlist::instance()->preferredAudio()) {
-                    audioTrack = i;
-                    break;
-                }
-            }
-            if (audioTrack >= 0) {
-                _player->setActiveAudioTrack(entry.audioTrack);
-            }
-        }
-        if (entry.subtitleTrack >= 0) {
-            _player->setActiveSubtitleTrack(entry.subtitleTrack);
-        } else if (entry.subtitleTrack == PlaylistEntry::NoTrack) {
-            // do nothing
-        } else if (metaData.subtitleTracks.size() > 0 && Playlist::instance()->wantSubtitle()) {
-            int subtitleTrack = 0;
-            for (int i = 0; i < int(metaData.subtitleTracks.length()); i++) {
-                QLocale subtitleLanguage = metaData.subtitleTracks[i].value(QMediaMetaData::Language).toLocale();
-                if (subtitleLanguage == Playlist::instance()->preferredSubtitle()) {
-                    subtitleTrack = i;
-                    break;
-                }
-            }
-            _player->setActiveSubtitleTrack(subtitleTrack);
+    discardNextPlayer();
+    _switchEntry = entry;
+    _switchMetaData = MetaData();
+    if (_player->playbackState() != QMediaPlayer::StoppedState) {
+        setSwitchState(Switch_Stopping, 5000);
+        _playerIgnoreNextStop = true;
+        _player->setSource(QUrl());
+        // the player might have stopped synchronously
+        if (_switchState == Switch_Stopping && _player->playbackState() == QMediaPlayer::StoppedState) {
+            _playerIgnoreNextStop = false;
+            switchStopped();
         }
-        _videoSink->newPlaylistEntry(entry, metaData);
-        _player->play();
+    } else {
+        _player->setSource(QUrl());
+        switchStopped();
+    }
+}
+
+void Bino::setSwitchState(SwitchState state, int timeoutMilliseconds)
+{
+    _switchState = state;
+    if (timeoutMilliseconds > 0)
+        _switchTimer.start(timeoutMilliseconds);
+    else
+        _switchTimer.stop();
+}
+
+void Bino::switchStopped()
+{
+    if (_switchEntry.noMedia()) {
+        setSwitchState(Switch_Idle);
+        _transitionTimer.invalidate();
+        emit stateChanged();
+        return;
+    }
+    if (_switchMetaData.detectFromCache(_switchEntry.url)) {
+        switchMetaDataReady();
+    } else {
+        setSwitchState(Switch_MetaData, 30000);
+        MetaDataPrefetcher::instance()->request(_switchEntry.url);
     }
+}
+
+void Bino::switchMetaDataReady()
+{
+    setSwitchState(Switch_Opening, 30000);
+    // Still images are decoded directly into a video frame
+    if (ImageSource::handles(_switchEntry.url)) {
+        _imageSource->setSource(_switchEntry.url);
+        return;
+    }
+    _player->setSource(_switchEntry.url);
+}
+
+void Bino::switchOpened()
+{
+    setSwitchState(Switch_Idle);
+    if (showingImage()) {
+        _videoSink->newPlaylistEntry(_switchEntry, _switchMetaData);
+        _imageSource->play();
+        prerollNextPlayer();
+        updateSpareFrame();
+        emit stateChanged();
+        return;
+    }
+    if (_switchMetaData.videoTracks.isEmpty())
+        _overlayAudio.updateParameters(_switchMetaData);
+    selectTracks(_player, _switchEntry, _switchMetaData);
+    _videoSink->newPlaylistEntry(_switchEntry, _switchMetaData);
+    _player->play();
+    prerollNextPlayer();
+    emit stateChanged();
+}
+
+void Bino::switchFailed()
+{
+    setSwitchState(Switch_Idle);
+    _transitionTimer.invalidate();
     emit stateChanged();
 }
 
+void Bino::switchTimeout()
+{
+    switch (_switchState) {
+    case Switch_Idle:
+        break;
+    case Switch_Stopping:
+        LOG_DEBUG("media player did not report stopping; continuing anyway");
+        _playerIgnoreNextStop = false;
+        switchStopped();
+        break;
+    case Switch_MetaData:
+        LOG_DEBUG("timeout while waiting for meta data of %s; continuing without", qPrintable(_switchEntry.url.toString()));
+        switchMetaDataReady();
+        break;
+    case Switch_Opening:
+        LOG_WARNING("%s", qPrintable(tr("Timeout while opening %1").arg(_switchEntry.url.toString())));
+        _player->setSource(QUrl());
+        _imageSource->setSource(QUrl());
+        switchFailed();
+        break;
+    }
+}
+
 void Bino::quit()
 {
     stop();
@@ -340,10 +714,24 @@ void Bino::setPosition(float pos)
     _player->setPosition(pos * _player->duration());
 }
 
+void Bino::setPlaybackRate(double rate)
+{
+    if (!playlistMode())
+        return;
+    _player->setPlaybackRate(rate);
+}
+
 void Bino::togglePause()
 {
     if (!playlistMode())
         return;
+    if (showingImage()) {
+        if (_imageSource->state() == ImageSource::Playing)
+            _imageSource->pause();
+        else
+            _imageSource->play();
+        return;
+    }
     if (_player->playbackState() == QMediaPlayer::PlayingState) {
         _player->pause();
         emit stateChanged();
@@ -357,6 +745,10 @@ void Bino::pause()
 {
     if (!playlistMode())
         return;
+    if (showingImage()) {
+        _imageSource->pause();
+        return;
+    }
     if (_player->playbackState() == QMediaPlayer::PlayingState) {
         _player->pause();
         emit stateChanged();
@@ -367,6 +759,10 @@ void Bino::play()
 {
     if (!playlistMode())
         return;
+    if (showingImage()) {
+        _imageSource->play();
+        return;
+    }
     if (_player->playbackState() != QMediaPlayer::PlayingState) {
         _player->play();
         emit stateChanged();
@@ -402,6 +798,13 @@ void Bino::stop()
 {
     if (!playlistMode())
         return;
+    discardNextPlayer();
+    if (_switchState != Switch_Idle) {
+        LOG_DEBUG("media switch to %s cancelled", qPrintable(_switchEntry.url.toString()));
+        setSwitchState(Switch_Idle);
+        _transitionTimer.invalidate();
+    }
+    _imageSource->stop();
     if (_player->playbackState() != QMediaPlayer::StoppedState) {
         _player->stop();
         emit stateChanged();
@@ -479,16 +882,22 @@ bool Bino::muted() const
 
 bool Bino::paused() const
 {
+    if (playlistMode() && showingImage())
+        return _imageSource->state() == ImageSource::Paused;
     return (playlistMode() && _player->playbackState() == QMediaPlayer::PausedState);
 }
 
 bool Bino::playing() const
 {
+    if (playlistMode() && showingImage())
+        return _imageSource->state() == ImageSource::Playing;
     return (playlistMode() && _player->playbackState() == QMediaPlayer::PlayingState);
 }
 
 bool Bino::stopped() const
 {
+    if (playlistMode() && showingImage())
+        return _imageSource->state() == ImageSource::Stopped;
     return (playlistMode() && _player->playbackState() == QMediaPlayer::StoppedState);
 }
 
@@ -496,15 +905,42 @@ QUrl Bino::url() const
 {
     QUrl url;
     if (playing() || paused())
-        url = _player->source();
+        url = (showingImage() ? _imageSource->source() : _player->source());
     return url;
 }
 
+qint64 Bino::position() const
+{
+    return (playlistMode() && !showingImage() ? _player->position() : 0);
+}
+
+qint64 Bino::duration() const
+{
+    return (playlistMode() && !showingImage() ? _player->duration() : 0);
+}
+
+unsigned long long Bino::frameId() const
+{
+    return _frame.frameId;
+}
+
+double Bino::playbackRate() const
+{
+    return (playlistMode() ? _player->playbackRate() : 1.0);
+}
+
+Bino::FrameStatistics Bino::frameStatistics() const
+{
+    return _frameStatistics;
+}
+
 int Bino::videoTrack() const
 {
     int t = -1;
     if (captureMode())
         t = 0;
+    else if (playlistMode() && showingImage())
+        t = 0;
     else if (playlistMode())
         t = _player->activeVideoTrack();
     return t;
@@ -570,10 +1006,12 @@ void Bino::serializeDynamicData(QDataStream& ds)
     ds << _frameWasSerialized;
     if (!_frameWasSerialized) {
         ds << _frame;
-        if (_frame.inputMode == Input_Alternating_LR
-                || _frame.inputMode == Input_Alternating_RL) {
+        // tiled frames do not use _extFrame; tell the reader whether it follows
+        bool withExtFrame = (!_frameIsTiled && (_frame.inputMode == Input_Alternating_LR
+                    || _frame.inputMode == Input_Alternating_RL));
+        ds << withExtFrame;
+        if (withExtFrame)
             ds << _extFrame;
-        }
         _frameWasSerialized = true;
     }
     // the subtitle is serialized with the frame
@@ -589,10 +1027,10 @@ void Bino::deserializeDynamicData(QDataStream& ds)
     ds >> noNewFrame;
     if (!noNewFrame) {
         ds >> _frame;
-        if (_frame.inputMode == Input_Alternating_LR
-                || _frame.inputMode == Input_Alternating_RL) {
+        bool withExtFrame;
+        ds >> withExtFrame;
+        if (withExtFrame)
             ds >> _extFrame;
-        }
         _frameIsNew = true;
     }
     // the subtitle is serialized with the frame
@@ -620,10 +1058,16 @@ bool Bino::initProcess()
 
     // Qt-based OpenGL initialization
     initializeOpenGLFunctions();
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &_maxTextureSize);
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &_maxArrayTextureLayers);
+    _tileSize = 1;
+    while (_tileSize * 2 <= std::min(_maxTextureSize, 4096))
+        _tileSize *= 2;
 
     // FBO and PBO
     glGenFramebuffers(1, &_viewFbo);
     glGenFramebuffers(1, &_frameFbo);
+    glGenFramebuffers(1, &_tileMipmapFbo);
     glGenTextures(1, &_depthTex);
     glBindTexture(GL_TEXTURE_2D, _depthTex);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -818,20 +1262,91 @@ bool Bino::initProcess()
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     if (haveAnisotropicFiltering)
         glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY, 4.0f);
+    glGenTextures(1, &_spareFrameTex);
+    glBindTexture(GL_TEXTURE_2D, _spareFrameTex);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    if (haveAnisotropicFiltering)
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY, 4.0f);
+    glGenTextures(1, &_frameTilesTex);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, _frameTilesTex);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    if (haveAnisotropicFiltering)
+        glTexParameterf(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_ANISOTROPY, 4.0f);
+    LOG_DEBUG("frames larger than %d pixels will use tiles of %d pixels", _maxTextureSize, _tileSize);
     CHECK_GL();
 
-    // Overlay textures (subtitles and UI)
-    glGenTextures(3, _overlayTexs);
+    // Overlay textures (audio, subtitles and UI)
+    _haveAnisotropicFiltering = haveAnisotropicFiltering;
+    _haveTextureStorage = checkTextureStorageAvailability();
     for (int i = 0; i < 3; i++) {
-        glBindTexture(GL_TEXTURE_2D, _overlayTexs[i]);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        if (haveAnisotropicFiltering)
-            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY, 4.0f);
+        createOverlayTexture(i);
         CHECK_GL();
     }
+    glGenFramebuffers(1, &_overlayFbo);
+
+    // Overlay UI: instanced quads described by a uniform block
+    QString uiVS = readFile(":src/shader-ui.vert.glsl");
+    QString uiFS = readFile(":src/shader-ui.frag.glsl");
+    if (OpenGLType != OpenGL_Type_Desktop) {
+        uiVS.prepend("#version 300 es\n");
+        uiFS.prepend("#version 300 es\n"
+                "precision highp float;\n"); // pixel coordinates of large views
+    } else {
+        uiVS.prepend("#version 330\n");
+        uiFS.prepend("#version 330\n");
+    }
+    _uiPrg.addShaderFromSourceCode(QOpenGLShader::Vertex, uiVS);
+    _uiPrg.addShaderFromSourceCode(QOpenGLShader::Fragment, uiFS);
+    _uiPrg.link();
+    glUniformBlockBinding(_uiPrg.programId(), glGetUniformBlockIndex(_uiPrg.programId(), "UIBlock"), 0);
+    glGenBuffers(1, &_uiUbo);
+    glBindBuffer(GL_UNIFORM_BUFFER, _uiUbo);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(OverlayUIBlock), nullptr, GL_DYNAMIC_DRAW);
+    CHECK_GL();
+
+    // Subtitles: instanced glyph quads from a distance field atlas
+    glGenTextures(1, &_glyphAtlasTex);
+    glBindTexture(GL_TEXTURE_2D, _glyphAtlasTex);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, GlyphAtlas::size, GlyphAtlas::size, 0,
+            GL_RED, GL_UNSIGNED_BYTE, nullptr);
+    glGenVertexArrays(1, &_glyphVao);
+    glBindVertexArray(_glyphVao);
+    glGenBuffers(1, &_glyphBuf);
+    glBindBuffer(GL_ARRAY_BUFFER, _glyphBuf);
+    _glyphBufSize = 256;
+    glBufferData(GL_ARRAY_BUFFER, _glyphBufSize * sizeof(OverlaySubtitleGlyph), nullptr, GL_DYNAMIC_DRAW);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(OverlaySubtitleGlyph),
+            reinterpret_cast<void*>(offsetof(OverlaySubtitleGlyph, rect)));
+    glVertexAttribDivisor(0, 1);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(OverlaySubtitleGlyph),
+            reinterpret_cast<void*>(offsetof(OverlaySubtitleGlyph, atlasRect)));
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(1);
+    QString glyphVS = readFile(":src/shader-glyph.vert.glsl");
+    QString glyphFS = readFile(":src/shader-glyph.frag.glsl");
+    if (OpenGLType != OpenGL_Type_Desktop) {
+        glyphVS.prepend("#version 300 es\n");
+        glyphFS.prepend("#version 300 es\n"
+                "precision mediump float;\n");
+    } else {
+        glyphVS.prepend("#version 330\n");
+        glyphFS.prepend("#version 330\n");
+    }
+    _glyphPrg.addShaderFromSourceCode(QOpenGLShader::Vertex, glyphVS);
+    _glyphPrg.addShaderFromSourceCode(QOpenGLShader::Fragment, glyphFS);
+    _glyphPrg.link();
+    CHECK_GL();
 
     // Screen geometry
     glGenVertexArrays(1, &_screenVao);
@@ -868,10 +1383,10 @@ void Bino::updateMainProcess()
         _overlayUI.updateParameters(
                 (_frame.surroundMode != Surround_Off),
                 (_frame.inputMode != Input_Unknown && _frame.inputMode != Input_Mono),
-                _player->position(),
-                _player->duration(),
-                _player->isSeekable(),
-                _player->playbackState() == QMediaPlayer::PlayingState,
+                showingImage() ? 0 : _player->position(),
+                showingImage() ? 0 : _player->duration(),
+                showingImage() ? false : _player->isSeekable(),
+                playing(),
                 _overlayUIPointerInView,
                 _overlayUIPointerShow);
     }
@@ -920,15 +1435,16 @@ void Bino::rebuildColorPrgIfNecessary(int planeFormat, bool colorRangeSmall, int
     _colorPrgColorTransfer = colorTransfer;
 }
 
-void Bino::rebuildViewPrgIfNecessary(SurroundMode surroundMode, bool nonLinearOutput)
+void Bino::rebuildViewPrgIfNecessary(SurroundMode surroundMode, bool nonLinearOutput, bool tiled)
 {
     if (_viewPrg.isLinked()
             && _viewPrgSurroundMode == surroundMode
-            && _viewPrgNonlinearOutput == nonLinearOutput)
+            && _viewPrgNonlinearOutput == nonLinearOutput
+            && _viewPrgTiled == tiled)
         return;
 
-    LOG_DEBUG("rebuilding view program for surround mode %s, non linear output %s",
-            surroundModeToString(surroundMode), nonLinearOutput ? "true" : "false");
+    LOG_DEBUG("rebuilding view program for surround mode %s, non linear output %s, tiled %s",
+            surroundModeToString(surroundMode), nonLinearOutput ? "true" : "false", tiled ? "true" : "false");
     QString viewVS = readFile(":src/shader-view.vert.glsl");
     QString viewFS = readFile(":src/shader-view.frag.glsl");
     viewFS.replace("$SURROUND_DEGREES",
@@ -936,10 +1452,12 @@ void Bino::rebuildViewPrgIfNecessary(SurroundMode surroundMode, bool nonLinearOu
             : surroundMode == Surround_180 ? "180"
             : "0");
     viewFS.replace("$NONLINEAR_OUTPUT", nonLinearOutput ? "true" : "false");
+    viewFS.replace("$TILED", tiled ? "true" : "false");
     if (OpenGLType != OpenGL_Type_Desktop) {
         viewVS.prepend("#version 300 es\n");
         viewFS.prepend("#version 300 es\n"
-                "precision mediump float;\n");
+                "precision mediump float;\n"
+                "precision mediump sampler2DArray;\n");
     } else {
         viewVS.prepend("#version 330\n");
         viewFS.prepend("#version 330\n");
@@ -950,6 +1468,7 @@ void Bino::rebuildViewPrgIfNecessary(SurroundMode surroundMode, bool nonLinearOu
     _viewPrg.link();
     _viewPrgSurroundMode = surroundMode;
     _viewPrgNonlinearOutput = nonLinearOutput;
+    _viewPrgTiled = tiled;
 }
 
 static int alignmentFromBytesPerLine(const void* data, int bpl)
@@ -965,13 +1484,18 @@ static int alignmentFromBytesPerLine(const void* data, int bpl)
     return alignment;
 }
 
-void Bino::convertFrameToTexture(const VideoFrame& frame, unsigned int frameTex)
+void Bino::uploadFramePlanes(const VideoFrame& frame, const QRect& region, int* planeFormatPtr, int* planeCountPtr)
 {
-    // 1. Get the frame data into plane textures
-    int w = frame.width;
-    int h = frame.height;
+    int w = region.width();
+    int h = region.height();
     int planeFormat; // see shader-color.frag.glsl
     int planeCount;
+    // the region offset in the full resolution plane 0; chroma planes may be subsampled
+    auto setUnpackSkip = [&](int subsamplingX, int subsamplingY) {
+        glPixelStorei(GL_UNPACK_SKIP_PIXELS, region.x() / subsamplingX);
+        glPixelStorei(GL_UNPACK_SKIP_ROWS, region.y() / subsamplingY);
+    };
+    setUnpackSkip(1, 1);
     // reset swizzling for plane0; might be changed below depending in the format
     glBindTexture(GL_TEXTURE_2D, _planeTexs[0]);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_RED);
@@ -1047,6 +1571,7 @@ void Bino::convertFrameToTexture(const VideoFrame& frame, unsigned int frameTex)
             glPixelStorei(GL_UNPACK_ALIGNMENT, alignmentFromBytesPerLine(planeData[0], frame.qframe.bytesPerLine(0)));
             glPixelStorei(GL_UNPACK_ROW_LENGTH, frame.qframe.bytesPerLine(0));
             glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, w, h, 0, GL_RED, GL_UNSIGNED_BYTE, planeData[0]);
+            setUnpackSkip(2, 2);
             glBindTexture(GL_TEXTURE_2D, _planeTexs[1]);
             glPixelStorei(GL_UNPACK_ALIGNMENT, alignmentFromBytesPerLine(planeData[1], frame.qframe.bytesPerLine(1)));
             glPixelStorei(GL_UNPACK_ROW_LENGTH, frame.qframe.bytesPerLine(1));
@@ -1062,6 +1587,7 @@ void Bino::convertFrameToTexture(const VideoFrame& frame, unsigned int frameTex)
             glPixelStorei(GL_UNPACK_ALIGNMENT, alignmentFromBytesPerLine(planeData[0], frame.qframe.bytesPerLine(0)));
             glPixelStorei(GL_UNPACK_ROW_LENGTH, frame.qframe.bytesPerLine(0));
             glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, w, h, 0, GL_RED, GL_UNSIGNED_BYTE, planeData[0]);
+            setUnpackSkip(2, 1);
             glBindTexture(GL_TEXTURE_2D, _planeTexs[1]);
             glPixelStorei(GL_UNPACK_ALIGNMENT, alignmentFromBytesPerLine(planeData[1], frame.qframe.bytesPerLine(1)));
             glPixelStorei(GL_UNPACK_ROW_LENGTH, frame.qframe.bytesPerLine(1));
@@ -1077,6 +1603,7 @@ void Bino::convertFrameToTexture(const VideoFrame& frame, unsigned int frameTex)
             glPixelStorei(GL_UNPACK_ALIGNMENT, alignmentFromBytesPerLine(planeData[0], frame.qframe.bytesPerLine(0)));
             glPixelStorei(GL_UNPACK_ROW_LENGTH, frame.qframe.bytesPerLine(0));
             glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, w, h, 0, GL_RED, GL_UNSIGNED_BYTE, planeData[0]);
+            setUnpackSkip(2, 2);
             glBindTexture(GL_TEXTURE_2D, _planeTexs[1]);
             glPixelStorei(GL_UNPACK_ALIGNMENT, alignmentFromBytesPerLine(planeData[1], frame.qframe.bytesPerLine(1)));
             glPixelStorei(GL_UNPACK_ROW_LENGTH, frame.qframe.bytesPerLine(1));
@@ -1092,6 +1619,7 @@ void Bino::convertFrameToTexture(const VideoFrame& frame, unsigned int frameTex)
             glPixelStorei(GL_UNPACK_ALIGNMENT, alignmentFromBytesPerLine(planeData[0], frame.qframe.bytesPerLine(0)));
             glPixelStorei(GL_UNPACK_ROW_LENGTH, frame.qframe.bytesPerLine(0));
             glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, w, h, 0, GL_RED, GL_UNSIGNED_BYTE, planeData[0]);
+            setUnpackSkip(2, 2);
             glBindTexture(GL_TEXTURE_2D, _planeTexs[1]);
             glPixelStorei(GL_UNPACK_ALIGNMENT, alignmentFromBytesPerLine(planeData[1], frame.qframe.bytesPerLine(1)));
             glPixelStorei(GL_UNPACK_ROW_LENGTH, frame.qframe.bytesPerLine(1) / 2);
@@ -1104,6 +1632,7 @@ void Bino::convertFrameToTexture(const VideoFrame& frame, unsigned int frameTex)
             glPixelStorei(GL_UNPACK_ALIGNMENT, alignmentFromBytesPerLine(planeData[0], frame.qframe.bytesPerLine(0)));
             glPixelStorei(GL_UNPACK_ROW_LENGTH, frame.qframe.bytesPerLine(0) / 2);
             glTexImage2D(GL_TEXTURE_2D, 0, GL_R16, w, h, 0, GL_RED, GL_UNSIGNED_SHORT, planeData[0]);
+            setUnpackSkip(2, 2);
             glBindTexture(GL_TEXTURE_2D, _planeTexs[1]);
             glPixelStorei(GL_UNPACK_ALIGNMENT, alignmentFromBytesPerLine(planeData[1], frame.qframe.bytesPerLine(1)));
             glPixelStorei(GL_UNPACK_ROW_LENGTH, frame.qframe.bytesPerLine(1) / 4);
@@ -1131,21 +1660,19 @@ void Bino::convertFrameToTexture(const VideoFrame& frame, unsigned int frameTex)
     }
     glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
     glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
-    // 2. Convert plane textures into linear RGB in the frame texture
-    glBindTexture(GL_TEXTURE_2D, frameTex);
-    if (OpenGLType == OpenGL_Type_WebGL)
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_BGRA, GL_UNSIGNED_SHORT, nullptr);
-    else if (OpenGLType == OpenGL_Type_OpenGLES)
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB10_A2, w, h, 0, GL_RGBA, GL_UNSIGNED_INT_2_10_10_10_REV, nullptr);
-    else
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16, w, h, 0, GL_BGRA, GL_UNSIGNED_SHORT, nullptr);
-    glBindFramebuffer(GL_FRAMEBUFFER, _frameFbo);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, frameTex, 0);
-    glViewport(0, 0, w, h);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+    *planeFormatPtr = planeFormat;
+    *planeCountPtr = planeCount;
+}
+
+void Bino::drawColorConversion(const VideoFrame& frame, int planeFormat, int planeCount, const QVector4D& texcoordTransform)
+{
     glDisable(GL_DEPTH_TEST);
     rebuildColorPrgIfNecessary(planeFormat, frame.colorRangeSmall, frame.colorSpace, frame.colorTransfer);
     glUseProgram(_colorPrg.programId());
     _colorPrg.setUniformValue("masteringWhite", frame.masteringWhite);
+    _colorPrg.setUniformValue("texcoord_transform", texcoordTransform);
     for (int p = 0; p < planeCount; p++) {
         _colorPrg.setUniformValue(qPrintable(QString("plane") + QString::number(p)), p);
         glActiveTexture(GL_TEXTURE0 + p);
@@ -1153,22 +1680,377 @@ void Bino::convertFrameToTexture(const VideoFrame& frame, unsigned int frameTex)
     }
     glBindVertexArray(_quadVao);
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, 0);
+}
+
+void Bino::convertFrameToTexture(const VideoFrame& frame, unsigned int frameTex)
+{
+    // 1. Get the frame data into plane textures
+    int w = frame.width;
+    int h = frame.height;
+    int planeFormat, planeCount;
+    {
+        TRACE_SCOPE("upload", frame.frameId);
+        uploadFramePlanes(frame, QRect(0, 0, w, h), &planeFormat, &planeCount);
+    }
+    // 2. Convert plane textures into linear RGB in the frame texture
+    TRACE_SCOPE("color conversion", frame.frameId);
+    glBindTexture(GL_TEXTURE_2D, frameTex);
+    if (OpenGLType == OpenGL_Type_WebGL)
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_BGRA, GL_UNSIGNED_SHORT, nullptr);
+    else if (OpenGLType == OpenGL_Type_OpenGLES)
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB10_A2, w, h, 0, GL_RGBA, GL_UNSIGNED_INT_2_10_10_10_REV, nullptr);
+    else
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16, w, h, 0, GL_BGRA, GL_UNSIGNED_SHORT, nullptr);
+    glBindFramebuffer(GL_FRAMEBUFFER, _frameFbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, frameTex, 0);
+    glViewport(0, 0, w, h);
+    drawColorConversion(frame, planeFormat, planeCount);
     glBindTexture(GL_TEXTURE_2D, frameTex);
     glGenerateMipmap(GL_TEXTURE_2D);
 }
 
-void Bino::overlayToTexture(const QImage& img, unsigned int tex)
+/* Frames that are larger than the maximum texture size (e.g. panoramic
+ * still images) are split into a grid of tiles, stored as layers of a
+ * 2D array texture in row-major order. Each layer covers _tileSize x _tileSize
+ * frame pixels: the tile itself and a gutter of the neighboring frame pixels
+ * around it, so that filtering and mipmapping do not create seams at tile
+ * boundaries. Where a layer extends beyond the frame, it repeats the frame's
+ * edge pixels. Depending on the view and on the memory budget, the tiles can
+ * hold a reduced level of detail. They are converted progressively over
+ * multiple render passes, and the mipmaps of each tile are built right after
+ * its conversion, so that tiles are filtered correctly while others are
+ * still missing. The number of tiles is limited by the maximum number of
+ * array texture layers, which can be as low as 256 with OpenGL ES. */
+
+static const qint64 frameTilesMemoryBudget = qint64(1024) * 1024 * 1024;
+static const int frameTilesGutter = 8; // in layer texels at any level of detail; covers three mipmap levels
+
+void Bino::convertFrameToTile(int tile)
+{
+    TRACE_SCOPE("tile conversion", _frame.frameId);
+    int column = tile % _tileColumns;
+    int row = tile / _tileColumns;
+    int gutter = frameTilesGutter << _tileLod; // in frame pixels
+    QRect layerRegion = QRect(column * _tileStride - gutter, row * _tileStride - gutter, _tileSize, _tileSize);
+    QRect region = layerRegion & QRect(0, 0, _frame.width, _frame.height);
+    LOG_FIREHOSE("converting frame tile %d (%d,%d %dx%d) at level %d", tile,
+            region.x(), region.y(), region.width(), region.height(), _tileLod);
+    // 1. Get the frame data of the tile region into plane textures
+    int planeFormat, planeCount;
+    uploadFramePlanes(_frame, region, &planeFormat, &planeCount);
+    if (_tileLod > 0) {
+        // minify via plane mipmaps to avoid aliasing
+        for (int p = 0; p < planeCount; p++) {
+            glBindTexture(GL_TEXTURE_2D, _planeTexs[p]);
+            glGenerateMipmap(GL_TEXTURE_2D);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        }
+    }
+    // 2. Convert plane textures into linear RGB in the tile layer
+    glBindFramebuffer(GL_FRAMEBUFFER, _frameFbo);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, _frameTilesTex, 0, tile);
+    glViewport(0, 0, _tileSize >> _tileLod, _tileSize >> _tileLod);
+    // map the layer to its region; outside of the frame, the plane textures clamp to their edges
+    QVector4D texcoordTransform(
+            float(layerRegion.width()) / region.width(),
+            float(layerRegion.height()) / region.height(),
+            float(layerRegion.x() - region.x()) / region.width(),
+            float(layerRegion.y() - region.y()) / region.height());
+    drawColorConversion(_frame, planeFormat, planeCount, texcoordTransform);
+    if (_tileLod > 0) {
+        for (int p = 0; p < planeCount; p++) {
+            glBindTexture(GL_TEXTURE_2D, _planeTexs[p]);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, p == 0 ? GL_NEAREST : GL_LINEAR);
+        }
+    }
+}
+
+void Bino::generateTileMipmaps(int tile)
 {
-    glBindTexture(GL_TEXTURE_2D, tex);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB8_ALPHA8,
-            img.width(), img.height(), 0, GL_BGRA,
-            GL_UNSIGNED_BYTE, img.bits());
-    glGenerateMipmap(GL_TEXTURE_2D);
+    // glGenerateMipmap() would process all layers, so blit each level of
+    // this layer from the previous one instead
+    int size = _tileSize >> _tileLod;
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, _tileMipmapFbo);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _frameFbo);
+    for (int level = 1; (size >> level) > 0; level++) {
+        glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, _frameTilesTex, level - 1, tile);
+        glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, _frameTilesTex, level, tile);
+        glBlitFramebuffer(0, 0, size >> (level - 1), size >> (level - 1),
+                0, 0, size >> level, size >> level, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, _frameFbo);
+}
+
+void Bino::updateFrameTiles(int screenWidth, int screenHeight, int frameViewWidth, int frameViewHeight)
+{
+    // the tile grid depends on the level of detail since the gutter does
+    auto tileStride = [=](int lod) { return _tileSize - ((2 * frameTilesGutter) << lod); };
+    auto tileCountAt = [=](int lod) {
+        int stride = tileStride(lod);
+        return qint64((_frame.width + stride - 1) / stride) * ((_frame.height + stride - 1) / stride);
+    };
+
+    // Choose the level of detail: there is no point in storing more frame
+    // pixels than the current view can show...
+    float framePixelsPerScreenPixel;
+    if (_frame.surroundMode == Surround_Off) {
+        framePixelsPerScreenPixel = std::max(float(frameViewWidth) / std::max(screenWidth, 1),
+                float(frameViewHeight) / std::max(screenHeight, 1));
+    } else {
+        // the frame view height covers 180 degrees
+        framePixelsPerScreenPixel = frameViewHeight * (_lastVerticalFOV / 180.0f) / std::max(screenHeight, 1);
+    }
+    int lod = 0;
+    while (framePixelsPerScreenPixel >= 2.0f) {
+        framePixelsPerScreenPixel /= 2.0f;
+        lod++;
+    }
+    // ... and the tiles must fit into the memory budget (including mipmaps)
+    // and into the array texture layers.
+    // The gutter must not take up more than half of a layer.
+    int maxLod = 0;
+    while ((_tileSize >> (maxLod + 1)) >= 4 * frameTilesGutter)
+        maxLod++;
+    qint64 texelBytes = (OpenGLType == OpenGL_Type_OpenGLES ? 4 : 8);
+    while (lod < maxLod
+            && (tileCountAt(lod) > _maxArrayTextureLayers
+                || tileCountAt(lod) * texelBytes * (_tileSize >> lod) * (_tileSize >> lod) * 4 / 3 > frameTilesMemoryBudget)) {
+        lod++;
+    }
+    lod = std::min(lod, maxLod);
+
+    // (Re)allocate the tiles if necessary
+    int tileCount = _tileColumns * _tileRows;
+    glBindTexture(GL_TEXTURE_2D_ARRAY, _frameTilesTex);
+    if (lod != _tileLod) {
+        int size = _tileSize >> lod;
+        _tileStride = tileStride(lod);
+        _tileColumns = (_frame.width + _tileStride - 1) / _tileStride;
+        _tileRows = (_frame.height + _tileStride - 1) / _tileStride;
+        if (qint64(_tileColumns) * _tileRows > _maxArrayTextureLayers) {
+            // even the lowest level of detail needs too many tiles; show what fits
+            LOG_WARNING("%s", qPrintable(tr("Frame size %1x%2 is too large; showing only part of it")
+                        .arg(_frame.width).arg(_frame.height)));
+            _tileColumns = std::min(_tileColumns, _maxArrayTextureLayers);
+            _tileRows = _maxArrayTextureLayers / _tileColumns;
+        }
+        tileCount = _tileColumns * _tileRows;
+        LOG_DEBUG("allocating %dx%d frame tiles of size %dx%d at level %d",
+                _tileColumns, _tileRows, size, size, lod);
+        int levels = 0;
+        for (int level = 0; (size >> level) > 0; level++) {
+            int s = size >> level;
+            if (OpenGLType == OpenGL_Type_WebGL)
+                glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA, s, s, tileCount, 0, GL_BGRA, GL_UNSIGNED_SHORT, nullptr);
+            else if (OpenGLType == OpenGL_Type_OpenGLES)
+                glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGB10_A2, s, s, tileCount, 0, GL_RGBA, GL_UNSIGNED_INT_2_10_10_10_REV, nullptr);
+            else
+                glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA16, s, s, tileCount, 0, GL_BGRA, GL_UNSIGNED_SHORT, nullptr);
+            levels++;
+        }
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levels - 1);
+        _tileLod = lod;
+        _tileIsReady.fill(false, tileCount);
+    }
+    if (!_tileIsReady.contains(false))
+        return;
+
+    // Convert as many tiles as the time budget allows
+    QElapsedTimer timer;
+    timer.start();
+    for (int t = 0; t < tileCount; t++) {
+        if (_tileIsReady[t])
+            continue;
+        convertFrameToTile(t);
+        generateTileMipmaps(t);
+        _tileIsReady[t] = true;
+        if (_tileConversionBudget >= 0 && timer.elapsed() >= _tileConversionBudget)
+            break;
+    }
+    if (_tileIsReady.contains(false)) {
+        LOG_FIREHOSE("%lld of %d frame tiles are ready", qint64(_tileIsReady.count(true)), tileCount);
+        emit renderRequested();
+    } else {
+        LOG_DEBUG("all %d frame tiles are ready after this pass", tileCount);
+    }
+}
+
+void Bino::createOverlayTexture(int i)
+{
+    glGenTextures(1, &_overlayTexs[i]);
+    glBindTexture(GL_TEXTURE_2D, _overlayTexs[i]);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    if (_haveAnisotropicFiltering)
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY, 4.0f);
+    _overlayTexWidth[i] = 0;
+    _overlayTexHeight[i] = 0;
+    _overlayTexMipmaps[i] = false;
+}
+
+bool Bino::prepareOverlayTexture(int i, int width, int height, bool minified)
+{
+    /* In GUI mode, the overlay has the size of the view and is drawn 1:1 into
+     * the view texture. Only VR screens and surround video can minify it,
+     * unless the caller sized the overlay so that it is never minified. */
+    bool mipmaps = minified && (_screen.aspectRatio > 0.0f || _frame.surroundMode != Surround_Off);
+    glBindTexture(GL_TEXTURE_2D, _overlayTexs[i]);
+    if (width == _overlayTexWidth[i] && height == _overlayTexHeight[i] && mipmaps == _overlayTexMipmaps[i])
+        return false;
+    int levels = 1;
+    if (mipmaps) {
+        while (std::max(width, height) >> levels)
+            levels++;
+    }
+    if (_haveTextureStorage) {
+        // immutable storage cannot be reallocated, we need a new texture
+        glDeleteTextures(1, &_overlayTexs[i]);
+        createOverlayTexture(i);
+        glTexStorage2D(GL_TEXTURE_2D, levels, GL_SRGB8_ALPHA8, width, height);
+    } else {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB8_ALPHA8, width, height, 0,
+                GL_BGRA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    _overlayTexWidth[i] = width;
+    _overlayTexHeight[i] = height;
+    _overlayTexMipmaps[i] = mipmaps;
+    return true;
+}
+
+void Bino::overlayToTexture(Overlay& overlay, int i)
+{
+    const QImage& img = overlay.image();
+    QRect rect = overlay.dirtyRect();
+    if (prepareOverlayTexture(i, img.width(), img.height()))
+        rect = img.rect();
+    if (!rect.isEmpty()) {
+        LOG_FIREHOSE("overlay %d: uploading %dx%d pixels at %d,%d", i, rect.width(), rect.height(), rect.x(), rect.y());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, img.bytesPerLine() / 4);
+        glPixelStorei(GL_UNPACK_SKIP_PIXELS, rect.x());
+        glPixelStorei(GL_UNPACK_SKIP_ROWS, rect.y());
+        glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x(), rect.y(), rect.width(), rect.height(),
+                GL_BGRA, GL_UNSIGNED_BYTE, img.constBits());
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+        glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+        if (_overlayTexMipmaps[i])
+            glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    overlay.resetChanges();
+}
+
+void Bino::renderOverlayUI()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, _overlayFbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _overlayTexs[2], 0);
+    glViewport(0, 0, _overlayUI.width(), _overlayUI.height());
+    const float transparent[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    glClearBufferfv(GL_COLOR, 0, transparent);
+    if (_overlayUI.quadCount() > 0) {
+        LOG_FIREHOSE("overlay UI: drawing %d quads", _overlayUI.quadCount());
+        glDisable(GL_DEPTH_TEST);
+        // the shader computes linear RGB, and the texture stores sRGB
+        if (OpenGLType == OpenGL_Type_Desktop)
+            glEnable(GL_FRAMEBUFFER_SRGB);
+        glEnable(GL_BLEND);
+        glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        glBindBuffer(GL_UNIFORM_BUFFER, _uiUbo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(OverlayUIBlock), &(_overlayUI.block()));
+        glBindBufferBase(GL_UNIFORM_BUFFER, 0, _uiUbo);
+        glUseProgram(_uiPrg.programId());
+        glBindVertexArray(_quadVao);
+        glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, 0, _overlayUI.quadCount());
+        glDisable(GL_BLEND);
+        if (OpenGLType == OpenGL_Type_Desktop)
+            glDisable(GL_FRAMEBUFFER_SRGB);
+    }
+    if (_overlayTexMipmaps[2]) {
+        glBindTexture(GL_TEXTURE_2D, _overlayTexs[2]);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+}
+
+void Bino::renderOverlaySubtitle()
+{
+    GlyphAtlas& atlas = _overlaySubtitle.atlas();
+    const QVector<OverlaySubtitleGlyph>& glyphs = _overlaySubtitle.glyphs();
+    const QRect& rect = atlas.dirtyRect();
+    if (!rect.isEmpty()) {
+        LOG_FIREHOSE("glyph atlas: uploading %dx%d pixels at %d,%d", rect.width(), rect.height(), rect.x(), rect.y());
+        const QImage& img = atlas.image();
+        glBindTexture(GL_TEXTURE_2D, _glyphAtlasTex);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, img.bytesPerLine());
+        glPixelStorei(GL_UNPACK_SKIP_PIXELS, rect.x());
+        glPixelStorei(GL_UNPACK_SKIP_ROWS, rect.y());
+        glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x(), rect.y(), rect.width(), rect.height(),
+                GL_RED, GL_UNSIGNED_BYTE, img.constBits());
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+        glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        atlas.resetDirtyRect();
+    }
+
+    // only clear the pixels of the previous glyphs
+    QRect glyphsRect;
+    for (const OverlaySubtitleGlyph& g : glyphs) {
+        glyphsRect |= QRect(std::floor(g.rect[0]), std::floor(g.rect[1]),
+                std::ceil(g.rect[0] + g.rect[2]) - std::floor(g.rect[0]),
+                std::ceil(g.rect[1] + g.rect[3]) - std::floor(g.rect[1]));
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, _overlayFbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _overlayTexs[1], 0);
+    glViewport(0, 0, _overlaySubtitle.width(), _overlaySubtitle.height());
+    if (!_subtitleRect.isEmpty()) {
+        const float transparent[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(_subtitleRect.x(), _subtitleRect.y(), _subtitleRect.width(), _subtitleRect.height());
+        glClearBufferfv(GL_COLOR, 0, transparent);
+        glDisable(GL_SCISSOR_TEST);
+    }
+    _subtitleRect = glyphsRect;
+    if (glyphs.size() > 0) {
+        LOG_FIREHOSE("subtitle: drawing %d glyphs", int(glyphs.size()));
+        glBindVertexArray(_glyphVao);
+        glBindBuffer(GL_ARRAY_BUFFER, _glyphBuf);
+        if (glyphs.size() > _glyphBufSize) {
+            _glyphBufSize = glyphs.size();
+            glBufferData(GL_ARRAY_BUFFER, _glyphBufSize * sizeof(OverlaySubtitleGlyph), nullptr, GL_DYNAMIC_DRAW);
+        }
+        glBufferSubData(GL_ARRAY_BUFFER, 0, glyphs.size() * sizeof(OverlaySubtitleGlyph), glyphs.constData());
+        glDisable(GL_DEPTH_TEST);
+        // the shader computes linear RGB, and the texture stores sRGB
+        if (OpenGLType == OpenGL_Type_Desktop)
+            glEnable(GL_FRAMEBUFFER_SRGB);
+        glEnable(GL_BLEND);
+        glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        glUseProgram(_glyphPrg.programId());
+        _glyphPrg.setUniformValue("viewport", QVector2D(_overlaySubtitle.width(), _overlaySubtitle.height()));
+        _glyphPrg.setUniformValue("atlas", 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, _glyphAtlasTex);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, glyphs.size());
+        glDisable(GL_BLEND);
+        if (OpenGLType == OpenGL_Type_Desktop)
+            glDisable(GL_FRAMEBUFFER_SRGB);
+    }
+    if (_overlayTexMipmaps[1]) {
+        glBindTexture(GL_TEXTURE_2D, _overlayTexs[1]);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
 }
 
 void Bino::preRenderProcess(int screenWidth, int screenHeight,
         int* viewCountPtr, int* viewWidthPtr, int* viewHeightPtr, float* frameDisplayAspectRatioPtr, bool* surroundPtr)
 {
+    QElapsedTimer timer;
+    timer.start();
     int viewCount = 2;
     int viewWidth = _frame.width;
     int viewHeight = _frame.height;
@@ -1222,6 +2104,8 @@ void Bino::preRenderProcess(int screenWidth, int screenHeight,
     case Surround_360:
         break;
     }
+    int frameViewWidth = viewWidth;
+    int frameViewHeight = viewHeight;
 
     /* If the screen resolution is better than the video resolution,
      * we want the screen resolution to determine the view texture size
@@ -1236,6 +2120,13 @@ void Bino::preRenderProcess(int screenWidth, int screenHeight,
             viewWidth = viewHeight * frameDisplayAspectRatio;
         }
     }
+    /* Very large (tiled) frames would result in view textures that exceed the
+     * maximum texture size. */
+    if (viewWidth > _maxTextureSize || viewHeight > _maxTextureSize) {
+        float scale = float(_maxTextureSize) / std::max(viewWidth, viewHeight);
+        viewWidth = std::max(1, int(viewWidth * scale));
+        viewHeight = std::max(1, int(viewHeight * scale));
+    }
 
     /* Store results */
     if (viewCountPtr)
@@ -1254,7 +2145,21 @@ void Bino::preRenderProcess(int screenWidth, int screenHeight,
 
     if (_frameIsNew) {
         // Convert _frame into _frameTex and, if needed, _extFrame into _extFrameTex.
-        convertFrameToTexture(_frame, _frameTex);
+        // Frames that are too large for a single texture are converted into tiles.
+        _frameIsTiled = (_frame.width > _maxTextureSize || _frame.height > _maxTextureSize);
+        if (_frameIsTiled) {
+            // the tile grid is chosen together with the level of detail
+            _tileLod = -1;
+            LOG_DEBUG("frame size %dx%d exceeds maximum texture size %d; using tiles",
+                    _frame.width, _frame.height, _maxTextureSize);
+        } else if (!_spareFrameIsNew && _spareFrame.isValid() && _frame.qframe == _spareFrame.qframe) {
+            // this frame was already converted ahead of time
+            LOG_FIREHOSE("using spare frame texture");
+            std::swap(_frameTex, _spareFrameTex);
+            _spareFrame.invalidate();
+        } else {
+            convertFrameToTexture(_frame, _frameTex);
+        }
         if (_frame.inputMode == Input_Alternating_LR
                 || _frame.inputMode == Input_Alternating_RL) {
             // the user might have switched to this mode without the extFrame
@@ -1265,23 +2170,57 @@ void Bino::preRenderProcess(int screenWidth, int screenHeight,
                 convertFrameToTexture(_extFrame, _extFrameTex);
         }
         // Render the subtitle
+        TRACE_SCOPE("subtitle overlay", _frame.frameId);
         _overlaySubtitle.updateParameters(_frame.subtitle);
-        if (_overlaySubtitle.redraw(viewWidth, viewHeight)) {
-            overlayToTexture(_overlaySubtitle.image(), _overlayTexs[1]);
+        // In surround mode with a field of view below 90 degrees, the cube face
+        // that shows the subtitle is larger than the screen. The glyphs are then
+        // drawn at the magnified resolution so that they stay sharp, and the
+        // texture does not need mipmaps.
+        int subtitleWidth = viewWidth;
+        int subtitleHeight = viewHeight;
+        bool subtitleMinified = true;
+        if (_frame.surroundMode != Surround_Off) {
+            float faceHeight = screenHeight / std::tan(qDegreesToRadians(_lastVerticalFOV) * 0.5f);
+            if (faceHeight >= subtitleHeight) {
+                float scale = std::min(faceHeight / subtitleHeight,
+                        float(_maxTextureSize) / std::max(subtitleWidth, subtitleHeight));
+                subtitleWidth = std::max(1, int(subtitleWidth * scale));
+                subtitleHeight = std::max(1, int(subtitleHeight * scale));
+                subtitleMinified = false;
+            }
+        }
+        bool changed = _overlaySubtitle.update(subtitleWidth, subtitleHeight);
+        if (prepareOverlayTexture(1, _overlaySubtitle.width(), _overlaySubtitle.height(), subtitleMinified)) {
+            // the new texture has undefined content
+            _subtitleRect = QRect(0, 0, _overlaySubtitle.width(), _overlaySubtitle.height());
+            changed = true;
+        }
+        if (changed) {
+            renderOverlaySubtitle();
         }
         // Done.
         _frameIsNew = false;
+        _frameStatistics.framesShown++;
+    } else if (_spareFrameIsNew) {
+        convertFrameToTexture(_spareFrame, _spareFrameTex);
+        _spareFrameIsNew = false;
     }
+    if (_frameIsTiled)
+        updateFrameTiles(screenWidth, screenHeight, frameViewWidth, frameViewHeight);
     // Render the audio overlay
     if (!_frame.isValid()) {
+        TRACE_SCOPE("audio overlay");
         if (_overlayAudio.redraw(viewWidth, viewHeight)) {
-            overlayToTexture(_overlayAudio.image(), _overlayTexs[0]);
+            overlayToTexture(_overlayAudio, 0);
         }
     }
     // Render the overlay UI into
     if (_overlayUIShow) {
-        if (_overlayUI.redraw(viewWidth, viewHeight)) {
-            overlayToTexture(_overlayUI.image(), _overlayTexs[2]);
+        TRACE_SCOPE("UI overlay", _frame.frameId);
+        // drawing on the GPU costs the same CPU time at any view size
+        bool changed = _overlayUI.update(viewWidth, viewHeight);
+        if (prepareOverlayTexture(2, _overlayUI.width(), _overlayUI.height()) || changed) {
+            renderOverlayUI();
         }
     }
 
@@ -1291,6 +2230,7 @@ void Bino::preRenderProcess(int screenWidth, int screenHeight,
     }
     _lastFrameInputMode = _frame.inputMode;
     _lastFrameSurroundMode = _frame.surroundMode;
+    _frameStatistics.renderNanoseconds += timer.nsecsElapsed();
 }
 
 void Bino::render(
@@ -1302,6 +2242,9 @@ void Bino::render(
         int view, // 0 = left, 1 = right
         int texWidth, int texHeight, unsigned int texture)
 {
+    TRACE_SCOPE(view == 0 ? "render left" : "render right", _frame.frameId);
+    QElapsedTimer timer;
+    timer.start();
     // Update screen
     switch (_screenType) {
     case ScreenUnited:
@@ -1419,8 +2362,11 @@ void Bino::render(
             std::swap(relWidth, relHeight);
         }
     }
+    // Remember the field of view for the level of detail of frame tiles
+    if (_frame.surroundMode != Surround_Off && projectionMatrix(1, 1) > 0.0f)
+        _lastVerticalFOV = qRadiansToDegrees(2.0f * std::atan(1.0f / projectionMatrix(1, 1)));
     // Set up shader program
-    rebuildViewPrgIfNecessary(_frame.surroundMode, finalRenderingStep);
+    rebuildViewPrgIfNecessary(_frame.surroundMode, finalRenderingStep, _frameIsTiled);
     glUseProgram(_viewPrg.programId());
     QMatrix4x4 projectionModelViewMatrix = projectionMatrix;
     if (_frame.surroundMode == Surround_Off)
@@ -1441,6 +2387,15 @@ void Bino::render(
     _viewPrg.setUniformValue("view_factor_y", viewFactorY);
     _viewPrg.setUniformValue("relative_width", relWidth);
     _viewPrg.setUniformValue("relative_height", relHeight);
+    if (_frameIsTiled) {
+        _viewPrg.setUniformValue("frameTiles", 4);
+        _viewPrg.setUniformValue("tile_grid", float(_tileColumns), float(_tileRows));
+        _viewPrg.setUniformValue("tile_factor", float(_frame.width) / _tileStride, float(_frame.height) / _tileStride);
+        _viewPrg.setUniformValue("tile_scale", float(_tileStride) / _tileSize);
+        _viewPrg.setUniformValue("tile_offset", float(frameTilesGutter << _tileLod) / _tileSize);
+        glActiveTexture(GL_TEXTURE4);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, _frameTilesTex);
+    }
     // Render scene
     glActiveTexture(GL_TEXTURE1);
     glBindTexture(GL_TEXTURE_2D, _overlayTexs[0]);
@@ -1480,6 +2435,8 @@ void Bino::render(
         glVertexAttrib1f(2, 1.0f); // overlay opacity is 1 everywhere on the screen
         glDrawElements(GL_TRIANGLES, _screen.indices.size(), GL_UNSIGNED_INT, 0);
     }
+    _frameStatistics.renderPasses++;
+    _frameStatistics.renderNanoseconds += timer.nsecsElapsed();
 }
 
 bool Bino::overlayUIPointerPress(const QPointF& pointerInView, bool lockUIEvenIfPointerNotOnBox)
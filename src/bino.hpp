@@ -32,9 +32,15 @@
 #include <QKeyEvent>
 #include <QScreenCapture>
 #include <QWindowCapture>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QList>
+#include <QRect>
+#include <QVector4D>
 
 #include "screen.hpp"
 #include "videosink.hpp"
+#include "imagesource.hpp"
 #include "playlist.hpp"
 #include "overlay-audio.hpp"
 #include "overlay-subtitle.hpp"
@@ -44,6 +50,7 @@
 class Bino : public QObject, QOpenGLExtraFunctions
 {
 Q_OBJECT
+friend class Benchmark; // see bench.cpp
 
 public:
     enum ScreenType {
@@ -53,6 +60,14 @@ public:
     };
     static constexpr float surroundCubeScale = 2.0f;
 
+    /* Cumulative counters for monitoring, see frameStatistics() */
+    struct FrameStatistics {
+        quint64 framesReceived = 0;     // video frames delivered by the player or image source
+        quint64 framesShown = 0;        // video frames that were uploaded for rendering
+        quint64 renderPasses = 0;       // calls of render(), i.e. one per view
+        qint64 renderNanoseconds = 0;   // time spent in preRenderProcess() and render()
+    };
+
 private:
     /* Data not directly relevant for rendering */
     bool _wantExit;
@@ -60,9 +75,32 @@ private:
     QAudioOutput* _audioOutput;
     // for playing a play list:
     QMediaPlayer* _player;
-    bool _playerAvailable;
-    bool _playerFailure;
     bool _playerIgnoreNextStop;
+    // for still images, which are shown without the player:
+    ImageSource* _imageSource;
+    // for switching to a new playlist entry without blocking; see mediaChanged()
+    enum SwitchState {
+        Switch_Idle,            // nothing to do
+        Switch_Stopping,        // waiting for the previous media to stop
+        Switch_MetaData,        // waiting for the meta data of the new media
+        Switch_Opening          // waiting for the player to open the new media
+    };
+    SwitchState _switchState;
+    PlaylistEntry _switchEntry;
+    MetaData _switchMetaData;
+    QTimer _switchTimer;
+    MetaDataPrefetcher* _ownMetaDataPrefetcher; // only if the application did not create one
+    // for gapless transitions: the next playlist entry, opened and paused at its first frame
+    bool _prerollNext;
+    QMediaPlayer* _nextPlayer;
+    QVideoSink* _nextVideoSink;
+    int _nextPlayerIndex;
+    PlaylistEntry _nextPlayerEntry;
+    MetaData _nextPlayerMetaData;
+    bool _nextPlayerWaitingForMetaData;
+    QVideoFrame _nextPlayerFirstFrame;
+    bool _nextPlayerReady;
+    QElapsedTimer _transitionTimer;
     // for capturing audio/video:
     QAudioInput* _audioInput;
     QCamera* _videoInput;
@@ -85,13 +123,31 @@ private:
     /* Static data for rendering, initialized in initProcess() */
     unsigned int _depthTex;
     unsigned int _frameFbo;
+    unsigned int _tileMipmapFbo; // reads the previous level when building the mipmaps of a tile
     unsigned int _viewFbo;
     unsigned int _quadVao;
     unsigned int _cubeVao;
     unsigned int _planeTexs[3];
     unsigned int _frameTex;
     unsigned int _extFrameTex;
+    unsigned int _spareFrameTex; // holds the next still image ahead of time
+    unsigned int _frameTilesTex; // 2D array texture for frames larger than _maxTextureSize
+    int _maxTextureSize;
+    int _maxArrayTextureLayers; // limits the number of frame tiles
+    int _tileSize; // edge length of a tile in frame pixels, a power of two
     unsigned int _overlayTexs[3];
+    int _overlayTexWidth[3], _overlayTexHeight[3];
+    bool _overlayTexMipmaps[3];
+    bool _haveAnisotropicFiltering;
+    bool _haveTextureStorage;
+    unsigned int _overlayFbo;
+    unsigned int _uiUbo;
+    QOpenGLShaderProgram _uiPrg;
+    unsigned int _glyphAtlasTex;
+    unsigned int _glyphVao, _glyphBuf;
+    int _glyphBufSize; // in glyphs
+    QRect _subtitleRect; // part of the subtitle texture that holds glyphs
+    QOpenGLShaderProgram _glyphPrg;
     unsigned int _screenVao, _positionBuf, _texcoordBuf, _indexBuf;
     QOpenGLShaderProgram _colorPrg;
     int _colorPrgPlaneFormat;
@@ -101,13 +157,26 @@ private:
     QOpenGLShaderProgram _viewPrg;
     SurroundMode _viewPrgSurroundMode;
     bool _viewPrgNonlinearOutput;
+    bool _viewPrgTiled;
 
     /* Dynamic data for rendering */
     VideoFrame _frame;
     VideoFrame _extFrame; // for alternating stereo
     bool _frameIsNew;
+    VideoFrame _spareFrame; // the next still image, to be uploaded to _spareFrameTex
+    bool _spareFrameIsNew;
+    // for frames that are too large for a single texture:
+    bool _frameIsTiled;
+    int _tileColumns, _tileRows;
+    int _tileStride; // distance between tiles in frame pixels; less than _tileSize due to the gutter
+    int _tileLod; // the tiles hold the frame at 1/2^lod of its resolution; -1 if not allocated
+    QList<bool> _tileIsReady;
+    int _tileConversionBudget; // in milliseconds per render pass; -1 = unlimited
+    float _lastVerticalFOV; // of the last surround render pass, in degrees
     bool _frameWasSerialized;
+    qint64 _newFrameTime; // media time of the frame that the video sink is completing, or -1
     bool _swapEyes;
+    FrameStatistics _frameStatistics;
     // for rendering the audio overlay:
     OverlayAudio _overlayAudio;
     // for rendering subtitles:
@@ -117,11 +186,37 @@ private:
     OverlayUI _overlayUI;
     bool _overlayUIShow;
 
+    QMediaPlayer* createPlayer();
+    bool showingImage() const;
+    void prefetchImages();
+    void updateSpareFrame();
+    void selectTracks(QMediaPlayer* player, const PlaylistEntry& entry, const MetaData& metaData);
+    void prerollNextPlayer();
+    void nextPlayerAvailable();
+    void nextPlayerMetaDataReady();
+    void discardNextPlayer();
+    void swapInNextPlayer(const PlaylistEntry& entry);
+    void setSwitchState(SwitchState state, int timeoutMilliseconds = 0);
+    void switchStopped();
+    void switchMetaDataReady();
+    void switchOpened();
+    void switchFailed();
+    void switchTimeout();
     void startCaptureMode(bool withAudioInput, const QAudioDevice& audioInputDevice, InputMode inputMode);
     void rebuildColorPrgIfNecessary(int planeFormat, bool colorRangeSmall, int colorSpace, int colorTransfer);
-    void rebuildViewPrgIfNecessary(SurroundMode surroundMode, bool nonLinearOutput);
+    void rebuildViewPrgIfNecessary(SurroundMode surroundMode, bool nonLinearOutput, bool tiled);
+    void uploadFramePlanes(const VideoFrame& frame, const QRect& region, int* planeFormat, int* planeCount);
+    void drawColorConversion(const VideoFrame& frame, int planeFormat, int planeCount,
+            const QVector4D& texcoordTransform = QVector4D(1.0f, 1.0f, 0.0f, 0.0f));
     void convertFrameToTexture(const VideoFrame& frame, unsigned int frameTex);
-    void overlayToTexture(const QImage& img, unsigned int text);
+    void convertFrameToTile(int tile);
+    void generateTileMipmaps(int tile);
+    void updateFrameTiles(int screenWidth, int screenHeight, int frameViewWidth, int frameViewHeight);
+    void createOverlayTexture(int i);
+    bool prepareOverlayTexture(int i, int width, int height, bool minified = true);
+    void overlayToTexture(Overlay& overlay, int i);
+    void renderOverlayUI();
+    void renderOverlaySubtitle();
 
 public:
     Bino(ScreenType screenType, const Screen& screen, bool swapEyes);
@@ -133,6 +228,9 @@ public:
      * starting either GUI or VR mode */
     void initializeOutput(const QAudioDevice& audioOutputDevice);
     void startPlaylistMode();
+    void setPrerollNext(bool preroll); // gapless playlist transitions; on by default
+    void setSlideshowDuration(int milliseconds); // how long still images are shown; 0 = until they end
+    void setTileConversionBudget(int milliseconds); // per render pass for very large frames; -1 = unlimited
     void startCaptureModeCamera(
             bool withAudioInput,
             const QAudioDevice& audioInputDevice,
@@ -160,6 +258,7 @@ public:
     void quit();
     void seek(qint64 milliseconds);
     void setPosition(float pos);
+    void setPlaybackRate(double rate); // for synchronized playback; 1 is normal speed
     void togglePause();
     void pause();
     void play();
@@ -183,6 +282,11 @@ public:
     bool playing() const;
     bool stopped() const;
     QUrl url() const;
+    qint64 position() const; // in milliseconds; 0 for still images
+    qint64 duration() const; // in milliseconds; 0 for still images
+    double playbackRate() const;
+    unsigned long long frameId() const; // of the current frame, for tracing
+    FrameStatistics frameStatistics() const;
     int videoTrack() const;
     int audioTrack() const;
     int subtitleTrack() const;
@@ -229,7 +333,10 @@ public slots:
 
 signals:
     void newVideoFrame();
+    void newVideoFrameTime(qint64 microseconds); // media time of a new frame, emitted from the event loop right before newVideoFrame()
+    void renderRequested(); // another render pass would make progress, e.g. upload the next still image
     void toggleFullscreen();
     void stateChanged();
     void wantQuit();
+    void mediaTransitionDone(double milliseconds); // from end of previous media to first frame of next
 };
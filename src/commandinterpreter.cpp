@@ -18,6 +18,9 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <cmath>
+
 #include <QtSystemDetection>
 #include <QTextStream>
 #include <QLocalSocket>
@@ -28,6 +31,8 @@
 #include <QMediaDevices>
 #include <QGuiApplication>
 #include <QWindowCapture>
+#include <QJsonDocument>
+#include <QDateTime>
 
 #ifdef Q_OS_UNIX
 # include <fcntl.h>
@@ -40,13 +45,21 @@
 #include "modes.hpp"
 #include "bino.hpp"
 #include "gui.hpp"
+#include "syncfollower.hpp"
 #include "log.hpp"
 
 
 static CommandInterpreter* commandInterpreterSingleton = nullptr;
 
 CommandInterpreter::CommandInterpreter() :
-    _notifier(QSocketNotifier::Read)
+    _notifier(QSocketNotifier::Read),
+    _lineNumber(0),
+    _started(false),
+    _processing(false),
+    _waitForStop(false),
+    _client(nullptr),
+    _eventsPending(false),
+    _lastFrameTime(-1)
 {
     Q_ASSERT(!commandInterpreterSingleton);
     commandInterpreterSingleton = this;
@@ -75,10 +88,9 @@ bool CommandInterpreter::init(enum Type type, const QString& name)
                 if (line.isEmpty() && in.atEnd())
                     break;
                 else
-                    _lineList.append(line);
+                    _lineList.append({ line, nullptr });
             }
             _file.close();
-            _moreLinesInFuture = false;
         }
         break;
     case Type_FIFO:
@@ -107,12 +119,12 @@ bool CommandInterpreter::init(enum Type type, const QString& name)
                         if (line.isEmpty() && in.atEnd())
                             break;
                         else
-                            _lineList.append(line);
+                            _lineList.append({ line, nullptr });
                     }
+                    processLines();
                     });
             _notifier.setSocket(_file.handle());
             _notifier.setEnabled(true);
-            _moreLinesInFuture = true;
         }
         break;
     case Type_LocalSocket:
@@ -125,22 +137,13 @@ bool CommandInterpreter::init(enum Type type, const QString& name)
             QLocalServer* server = &_localServer;
             connect(&_localServer, &QLocalServer::newConnection, [this, server]() {
                     QLocalSocket* client = server->nextPendingConnection();
-                    connect(client, &QLocalSocket::readyRead, [this, client]() {
-                            QTextStream in(client);
-                            in.setEncoding(QStringConverter::Utf8);
-                            for (;;) {
-                                QString line = in.readLine();
-                                if (line.isEmpty() && in.atEnd())
-                                    break;
-                                else
-                                    _lineList.append(line);
-                            }
-                            });
-                    connect(client, &QLocalSocket::disconnected, [client]() {
+                    connect(client, &QLocalSocket::readyRead, [this, client]() { readLines(client); });
+                    connect(client, &QLocalSocket::disconnected, [this, client]() {
+                            readLines(client, true);
+                            _subscriptions.remove(client);
                             client->deleteLater();
                             });
                     });
-            _moreLinesInFuture = true;
         }
         break;
     case Type_TcpSocket:
@@ -176,32 +179,34 @@ bool CommandInterpreter::init(enum Type type, const QString& name)
             QTcpServer* server = &_tcpServer;
             connect(server, &QTcpServer::newConnection, [this, server]() {
                     QTcpSocket* client = server->nextPendingConnection();
-                    connect(client, &QTcpSocket::readyRead, [this, client]() {
-                            QTextStream in(client);
-                            in.setEncoding(QStringConverter::Utf8);
-                            for (;;) {
-                                QString line = in.readLine();
-                                if (line.isEmpty() && in.atEnd())
-                                    break;
-                                else
-                                    _lineList.append(line);
-                            }
-                            });
-                    connect(client, &QTcpSocket::disconnected, [client]() {
+                    connect(client, &QTcpSocket::readyRead, [this, client]() { readLines(client); });
+                    connect(client, &QTcpSocket::disconnected, [this, client]() {
+                            readLines(client, true);
+                            _subscriptions.remove(client);
                             client->deleteLater();
                             });
                     });
-            _moreLinesInFuture = true;
         }
         break;
     }
-    _lineNumber = 0;
-    _waitForStop = false;
-    connect(&_timer, SIGNAL(timeout()), this, SLOT(processLine()));
     _waitTimer.setSingleShot(true);
+    connect(&_waitTimer, SIGNAL(timeout()), this, SLOT(processLines()));
     return true;
 }
 
+void CommandInterpreter::readLines(QIODevice* device, bool disconnected)
+{
+    // only complete lines; the rest stays buffered until more data arrives,
+    // unless the client disconnected without a final newline
+    while (device->canReadLine() || (disconnected && device->bytesAvailable() > 0)) {
+        QString line = QString::fromUtf8(device->canReadLine() ? device->readLine() : device->readAll());
+        while (line.endsWith('\n') || line.endsWith('\r'))
+            line.chop(1);
+        _lineList.append({ line, device });
+    }
+    processLines();
+}
+
 bool CommandInterpreter::isInitialized() const
 {
     return !_name.isNull();
@@ -209,8 +214,30 @@ bool CommandInterpreter::isInitialized() const
 
 void CommandInterpreter::start()
 {
-    if (isInitialized())
-        _timer.start(50); // every 50 msecs = 20 times per second
+    if (!isInitialized() || _started)
+        return;
+    _started = true;
+    // continue after 'wait stop' as soon as Bino stops
+    connect(Bino::instance(), &Bino::stateChanged, [this]() {
+            if (_waitForStop && Bino::instance()->stopped())
+                processLines();
+            });
+    // execute scheduled commands from the event loop, before the frame that reaches their time is rendered
+    connect(Bino::instance(), &Bino::newVideoFrameTime, [this](qint64 microseconds) {
+            newVideoFrameTime(microseconds);
+            });
+    connect(Playlist::instance(), &Playlist::mediaChanged, [this](const PlaylistEntry& entry) {
+            scheduleMediaChanged(entry.url);
+            });
+    // collect events for subscribed clients; they are sent from the event loop
+    connect(Bino::instance(), &Bino::stateChanged, [this]() {
+            if (!_subscriptions.isEmpty() && !_eventsPending) {
+                _eventsPending = true;
+                QMetaObject::invokeMethod(this, [this]() { sendEvents(); }, Qt::QueuedConnection);
+            }
+            });
+    // process the lines that are already available once the event loop runs
+    QMetaObject::invokeMethod(this, "processLines", Qt::QueuedConnection);
 }
 
 static int getOnOff(const QString& s)
@@ -223,30 +250,151 @@ static int getOnOff(const QString& s)
         return -1;
 }
 
-void CommandInterpreter::processLine()
+static bool isQuery(const QString& cmd)
 {
-    if (_waitTimer.isActive())
-        return;
-    if (_waitForStop && !Bino::instance()->stopped())
+    return cmd.startsWith("query ") || cmd.startsWith("subscribe ") || cmd.startsWith("unsubscribe ")
+        || cmd.startsWith("sync ");
+}
+
+bool CommandInterpreter::waiting() const
+{
+    return _waitTimer.isActive() || (_waitForStop && !Bino::instance()->stopped());
+}
+
+void CommandInterpreter::processLines()
+{
+    // Commands can trigger signals that lead back here; the outer call
+    // continues with the remaining lines.
+    if (!_started || _processing)
         return;
-    _waitForStop = false;
+    _processing = true;
+    while (!_lineList.isEmpty() && !waiting()) {
+        _waitForStop = false;
+        processLine();
+        emit commandProcessed();
+    }
+    // Queries and subscriptions do not change anything, so socket clients
+    // get their answers even while the other commands wait.
+    if (waiting()) {
+        for (int i = 0; i < _lineList.size(); ) {
+            if (_lineList[i].client && isQuery(_lineList[i].text.simplified())) {
+                _lineList.move(i, 0);
+                processLine();
+                emit commandProcessed();
+            } else {
+                i++;
+            }
+        }
+    }
+    _processing = false;
+}
 
-    if (_lineList.isEmpty()) {
-        if (!_moreLinesInFuture)
-            _timer.stop();
+/* Parse a media time given in seconds or as [hh:]mm:ss[.sss] */
+static bool parseMediaTime(const QString& s, qint64* microseconds)
+{
+    QStringList parts = s.split(':');
+    if (parts.size() > 3)
+        return false;
+    double seconds = 0.0;
+    for (int i = 0; i < parts.size(); i++) {
+        bool ok;
+        double v = parts[i].toDouble(&ok);
+        if (!ok || v < 0.0 || (i > 0 && v >= 60.0) || (i < parts.size() - 1 && v != std::floor(v)))
+            return false;
+        seconds = seconds * 60.0 + v;
+    }
+    *microseconds = seconds * 1e6;
+    return true;
+}
+
+/* Timestamps of consecutive frames never differ by more than this unless
+ * playback jumped, e.g. because of a seek or new media. */
+static const qint64 maxFrameTimeStep = 1000000;
+
+void CommandInterpreter::newVideoFrameTime(qint64 microseconds)
+{
+    qint64 lastFrameTime = _lastFrameTime;
+    _lastFrameTime = microseconds;
+    if (lastFrameTime < 0 || microseconds <= lastFrameTime || microseconds - lastFrameTime > maxFrameTimeStep) {
+        // Playback jumped: commands that were skipped are not executed,
+        // except at the start of the media.
+        if (microseconds > maxFrameTimeStep)
+            return;
+        lastFrameTime = -1;
+    }
+    QList<ScheduledCommand> due;
+    for (const ScheduledCommand& sc : std::as_const(_schedule)) {
+        if (sc.time > microseconds)
+            break;
+        if (sc.time > lastFrameTime)
+            due.append(sc);
+    }
+    // the commands may change the schedule, so execute them from a copy
+    int lineNumber = _lineNumber;
+    QIODevice* client = _client;
+    for (const ScheduledCommand& sc : std::as_const(due)) {
+        LOG_DEBUG("Command line %d at %.3f (frame %.3f): %s", sc.lineNumber,
+                sc.time / 1e6, microseconds / 1e6, qPrintable(sc.command));
+        _lineNumber = sc.lineNumber;
+        _client = sc.client;
+        processCommand(sc.command);
+    }
+    _lineNumber = lineNumber;
+    _client = client;
+}
+
+void CommandInterpreter::scheduleMediaChanged(const QUrl& url)
+{
+    if (url.isEmpty()) // stopped; the schedule stays for a restart
         return;
+    _lastFrameTime = -1;
+    for (int i = _schedule.size() - 1; i >= 0; i--) {
+        if (_schedule[i].url.isEmpty()) {
+            _schedule[i].url = url;
+        } else if (_schedule[i].url != url) {
+            LOG_DEBUG("Command line %d: removing scheduled command of previous media", _schedule[i].lineNumber);
+            _schedule.removeAt(i);
+        }
     }
+}
 
+void CommandInterpreter::processLine()
+{
     _lineNumber++;
-    QString cmd = QString(_lineList.first()).simplified();
-    _lineList.removeFirst();
+    Line line = _lineList.takeFirst();
+    QString cmd = line.text.simplified();
+    _client = line.client;
     LOG_DEBUG("Command line %d: %s", _lineNumber, qPrintable(cmd));
+    processCommand(cmd);
+}
 
+void CommandInterpreter::processCommand(const QString& cmd)
+{
     // empty lines and comments
     if (cmd.length() == 0 || cmd[0] == '#')
         return;
 
-    if (cmd == "quit") {
+    if (processQuery(cmd)) {
+        // handled
+    } else if (cmd.startsWith("at ")) {
+        int separator = cmd.indexOf(' ', 3);
+        qint64 time;
+        QString command = (separator < 0 ? QString() : cmd.mid(separator + 1));
+        if (separator < 0 || !parseMediaTime(cmd.mid(3, separator - 3), &time)
+                || command.startsWith("at ") || command.startsWith("wait ")) {
+            LOG_FATAL("%s", qPrintable(tr("Invalid argument in %1 line %2").arg(_name).arg(_lineNumber)));
+        } else {
+            const Playlist* playlist = Playlist::instance();
+            int index = playlist->currentIndex();
+            QUrl url = (index >= 0 && index < playlist->length() ? playlist->entries()[index].url : QUrl());
+            ScheduledCommand sc = { time, command, _client, _lineNumber, url };
+            auto it = std::upper_bound(_schedule.begin(), _schedule.end(), sc,
+                    [](const ScheduledCommand& a, const ScheduledCommand& b) { return a.time < b.time; });
+            _schedule.insert(it, sc);
+        }
+    } else if (cmd == "at-clear") {
+        _schedule.clear();
+    } else if (cmd == "quit") {
         Bino::instance()->quit();
     } else if (cmd.startsWith("wait ")) {
         if (cmd.mid(5) == "stop") {
@@ -542,3 +690,174 @@ void CommandInterpreter::processLine()
         LOG_FATAL("%s", qPrintable(tr("Invalid command %1 line %2").arg(cmd).arg(_lineNumber)));
     }
 }
+
+/* Queries and subscriptions of socket clients. All replies and events are
+ * single lines with one JSON object each. */
+
+static const qint64 maxPendingReplyBytes = 1024 * 1024;
+
+static QJsonObject stateObject()
+{
+    const Bino* bino = Bino::instance();
+    QJsonObject o;
+    o["state"] = (bino->playing() ? "playing" : bino->paused() ? "paused" : "stopped");
+    o["position_ms"] = bino->position();
+    o["duration_ms"] = bino->duration();
+    o["muted"] = bino->muted();
+    o["swap_eyes"] = bino->swapEyes();
+    o["input_mode"] = inputModeToString(bino->inputMode());
+    o["surround_mode"] = surroundModeToString(bino->surroundMode());
+    return o;
+}
+
+static QJsonObject mediaObject()
+{
+    const Bino* bino = Bino::instance();
+    QJsonObject o;
+    o["url"] = bino->url().toString();
+    o["playlist_index"] = Playlist::instance()->currentIndex();
+    o["video_track"] = bino->videoTrack();
+    o["audio_track"] = bino->audioTrack();
+    o["subtitle_track"] = bino->subtitleTrack();
+    return o;
+}
+
+/* The render time is averaged over the passes since the given counters */
+static QJsonObject statsObject(quint64 lastRenderPasses, qint64 lastRenderNanoseconds)
+{
+    Bino::FrameStatistics stats = Bino::instance()->frameStatistics();
+    QJsonObject o;
+    o["frames_received"] = qint64(stats.framesReceived);
+    o["frames_shown"] = qint64(stats.framesShown);
+    o["frames_dropped"] = qint64(stats.framesReceived - std::min(stats.framesReceived, stats.framesShown));
+    o["render_passes"] = qint64(stats.renderPasses);
+    quint64 passes = stats.renderPasses - lastRenderPasses;
+    o["render_ms_mean"] = (passes > 0 ? (stats.renderNanoseconds - lastRenderNanoseconds) / 1e6 / passes : 0.0);
+    const SyncFollower* syncFollower = SyncFollower::instance();
+    if (syncFollower && syncFollower->hasSkew()) {
+        o["sync_skew_ms"] = syncFollower->skew();
+        o["sync_round_trip_ms"] = syncFollower->roundTripTime();
+        o["sync_clock_offset_ms"] = syncFollower->clockOffset();
+    }
+    return o;
+}
+
+bool CommandInterpreter::processQuery(const QString& cmd)
+{
+    bool isQuery = cmd.startsWith("query ");
+    bool isSubscribe = cmd.startsWith("subscribe ");
+    bool isUnsubscribe = cmd.startsWith("unsubscribe ");
+    bool isSync = cmd.startsWith("sync ");
+    if (!isQuery && !isSubscribe && !isUnsubscribe && !isSync)
+        return false;
+    if (!_client) {
+        LOG_WARNING("%s", qPrintable(tr("Command %1 line %2 is only available on control sockets").arg(cmd).arg(_lineNumber)));
+        return true;
+    }
+    if (isSync) {
+        // for SyncFollower: the follower's timestamp is echoed unchanged
+        bool ok;
+        qint64 t0 = cmd.mid(5).toLongLong(&ok);
+        if (ok) {
+            QJsonObject reply = stateObject();
+            QJsonObject media = mediaObject();
+            reply["reply"] = "sync";
+            reply["url"] = media["url"];
+            reply["playlist_index"] = media["playlist_index"];
+            reply["t0"] = t0;
+            reply["clock_ms"] = QDateTime::currentMSecsSinceEpoch();
+            send(_client, reply);
+        }
+        return true;
+    }
+    QStringList args = cmd.mid(cmd.indexOf(' ') + 1).split(' ');
+    QString topic = args[0];
+    bool valid = (topic == "state" || topic == "media" || topic == "stats") && args.size() == 1;
+    int interval = 1000;
+    if (isSubscribe && topic == "stats" && args.size() == 2) {
+        interval = args[1].toInt(&valid);
+        valid = valid && interval >= 10;
+    }
+    if (!valid) {
+        LOG_FATAL("%s", qPrintable(tr("Invalid argument in %1 line %2").arg(_name).arg(_lineNumber)));
+        QJsonObject error;
+        error["error"] = QString("invalid argument: %1").arg(cmd);
+        send(_client, error);
+        return true;
+    }
+
+    if (isQuery) {
+        QJsonObject reply = (topic == "state" ? stateObject()
+                : topic == "media" ? mediaObject()
+                : statsObject(0, 0));
+        reply["reply"] = topic;
+        send(_client, reply);
+    } else {
+        Subscription& subscription = _subscriptions[_client];
+        if (topic == "state") {
+            subscription.state = isSubscribe;
+        } else if (topic == "media") {
+            subscription.media = isSubscribe;
+            _lastUrl = Bino::instance()->url();
+        } else {
+            delete subscription.statsTimer;
+            subscription.statsTimer = nullptr;
+            if (isSubscribe) {
+                Bino::FrameStatistics stats = Bino::instance()->frameStatistics();
+                subscription.lastRenderPasses = stats.renderPasses;
+                subscription.lastRenderNanoseconds = stats.renderNanoseconds;
+                QIODevice* client = _client;
+                subscription.statsTimer = new QTimer(client);
+                connect(subscription.statsTimer, &QTimer::timeout, [this, client]() { sendStats(client); });
+                subscription.statsTimer->start(interval);
+            }
+        }
+        if (!subscription.state && !subscription.media && !subscription.statsTimer)
+            _subscriptions.remove(_client);
+    }
+    return true;
+}
+
+void CommandInterpreter::send(QIODevice* client, const QJsonObject& object)
+{
+    // A client that does not read must not make us buffer without bounds
+    if (client->bytesToWrite() > maxPendingReplyBytes) {
+        LOG_FIREHOSE("command interpreter: dropping reply for a client that does not read");
+        return;
+    }
+    client->write(QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n');
+}
+
+void CommandInterpreter::sendStats(QIODevice* client)
+{
+    auto it = _subscriptions.find(client);
+    if (it == _subscriptions.end())
+        return;
+    QJsonObject event = statsObject(it->lastRenderPasses, it->lastRenderNanoseconds);
+    event["event"] = "stats";
+    send(client, event);
+    Bino::FrameStatistics stats = Bino::instance()->frameStatistics();
+    it->lastRenderPasses = stats.renderPasses;
+    it->lastRenderNanoseconds = stats.renderNanoseconds;
+}
+
+void CommandInterpreter::sendEvents()
+{
+    _eventsPending = false;
+    QJsonObject stateEvent = stateObject();
+    stateEvent["event"] = "state";
+    QUrl url = Bino::instance()->url();
+    bool mediaChanged = (url != _lastUrl);
+    _lastUrl = url;
+    QJsonObject mediaEvent;
+    if (mediaChanged) {
+        mediaEvent = mediaObject();
+        mediaEvent["event"] = "media";
+    }
+    for (auto it = _subscriptions.begin(); it != _subscriptions.end(); it++) {
+        if (it->state)
+            send(it.key(), stateEvent);
+        if (it->media && mediaChanged)
+            send(it.key(), mediaEvent);
+    }
+}
@@ -25,6 +25,10 @@
 #include <QLocalServer>
 #include <QTcpServer>
 #include <QTimer>
+#include <QPointer>
+#include <QHash>
+#include <QUrl>
+#include <QJsonObject>
 
 
 class CommandInterpreter : public QObject
@@ -52,17 +56,64 @@ private:
     // Type TcpSocket:
     QTcpServer _tcpServer;
     // List of commands: new lines will be appended when they become available,
-    // and the first line(s) will be consumed by the next processCommand() call.
-    QStringList _lineList;
-    bool _moreLinesInFuture;
+    // and all of them are consumed immediately by processLines() unless a wait
+    // command is active. The end of the wait continues the processing.
+    // Queries, subscriptions and sync pings of socket clients are answered
+    // during the wait.
+    // Each line remembers the socket client that sent it, for replies.
+    struct Line {
+        QString text;
+        QPointer<QIODevice> client; // null for files and FIFOs
+    };
+    QList<Line> _lineList;
     int _lineNumber;
-    // Timer handling required by processCommand():
+    bool _started;
+    bool _processing;
+    // State of the wait commands:
     bool _waitForStop;
-    QTimer _timer;
     QTimer _waitTimer;
+    // Replies and events for socket clients. Events are collected when the
+    // state changes and sent later from the event loop, so that monitoring
+    // does not happen on the render path.
+    struct Subscription {
+        bool state = false;
+        bool media = false;
+        QTimer* statsTimer = nullptr; // owned by the client
+        quint64 lastRenderPasses = 0;
+        qint64 lastRenderNanoseconds = 0;
+    };
+    QHash<QIODevice*, Subscription> _subscriptions;
+    QIODevice* _client; // the client that sent the current line, or nullptr
+    bool _eventsPending;
+    QUrl _lastUrl;
+    // Commands scheduled with 'at', sorted by media time. They are executed
+    // from the event loop before the video frame whose timestamp crosses
+    // their time is rendered, never inside a render pass. They belong to the playlist entry that was current when they
+    // were scheduled, or to the next one if there was none, and are removed
+    // when a different URL starts.
+    struct ScheduledCommand {
+        qint64 time; // media time in microseconds
+        QString command;
+        QPointer<QIODevice> client;
+        int lineNumber;
+        QUrl url; // empty until the next playlist entry starts
+    };
+    QList<ScheduledCommand> _schedule;
+    qint64 _lastFrameTime; // media time of the previous video frame, or -1
 
-private Q_SLOTS:
+    void readLines(QIODevice* device, bool disconnected = false);
+    bool waiting() const;
     void processLine();
+    void processCommand(const QString& cmd);
+    void newVideoFrameTime(qint64 microseconds);
+    void scheduleMediaChanged(const QUrl& url);
+    bool processQuery(const QString& cmd);
+    void send(QIODevice* client, const QJsonObject& object);
+    void sendStats(QIODevice* client);
+    void sendEvents();
+
+private Q_SLOTS:
+    void processLines();
 
 public:
     CommandInterpreter();
@@ -71,4 +122,7 @@ public:
     bool init(enum Type type, const QString& name);
     bool isInitialized() const;
     void start();
+
+signals:
+    void commandProcessed(); // a line was processed; used for latency measurements
 };
@@ -0,0 +1,389 @@
+/*
+ * This file is part of Bino, a 3D video player.
+ *
+ * Copyright (C) 2026
+ * Martin Lambers <marlam@marlam.de>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include <QFile>
+#include <QMap>
+#include <QtEndian>
+
+#include "containerprobe.hpp"
+#include "log.hpp"
+
+
+/* The file is memory mapped, so only the pages that hold the headers we
+ * look at are actually read, even if e.g. the MP4 moov box is at the end. */
+
+namespace {
+
+class Track
+{
+public:
+    bool isVideo = false;
+    InputMode inputMode = Input_Unknown;
+    bool equirectangular = false;
+    bool halfEquirectangular = false;
+};
+
+const int maxDepth = 16;
+
+bool isType(const uchar* p, const char* type)
+{
+    return std::memcmp(p, type, 4) == 0;
+}
+
+/* Bounds of an equirectangular projection, as used both by the MP4 equi box
+ * and the Matroska ProjectionPrivate element: version and flags (4 bytes),
+ * then top, bottom, left and right bounds as 0.32 fixed point numbers. */
+bool isHalfEquirectangular(const uchar* p, qint64 size)
+{
+    if (size < 20)
+        return false;
+    double left = qFromBigEndian<quint32>(p + 12) / 4294967296.0;
+    double right = qFromBigEndian<quint32>(p + 16) / 4294967296.0;
+    return (1.0 - left - right < 0.75);
+}
+
+/* MP4 / MOV: boxes; see ISO/IEC 14496-12 and the Spherical Video V2 RFC */
+
+void parseMP4Boxes(const uchar* data, qint64 size, int depth, bool sampleEntries, QList<Track>& tracks)
+{
+    qint64 pos = 0;
+    while (pos + 8 <= size) {
+        qint64 boxSize = qFromBigEndian<quint32>(data + pos);
+        const uchar* type = data + pos + 4;
+        qint64 headerSize = 8;
+        if (boxSize == 1) {
+            if (pos + 16 > size)
+                break;
+            boxSize = qFromBigEndian<quint64>(data + pos + 8);
+            headerSize = 16;
+        } else if (boxSize == 0) {
+            boxSize = size - pos;
+        }
+        if (boxSize < headerSize || boxSize > size - pos)
+            break;
+        const uchar* payload = data + pos + headerSize;
+        qint64 payloadSize = boxSize - headerSize;
+        pos += boxSize;
+        if (depth >= maxDepth)
+            continue;
+
+        if (sampleEntries) {
+            // a visual sample entry has 78 bytes of fixed fields before its child boxes
+            if (!tracks.isEmpty() && tracks.last().isVideo && payloadSize >= 78)
+                parseMP4Boxes(payload + 78, payloadSize - 78, depth + 1, false, tracks);
+        } else if (isType(type, "trak")) {
+            tracks.append(Track());
+            parseMP4Boxes(payload, payloadSize, depth + 1, false, tracks);
+        } else if (isType(type, "moov") || isType(type, "mdia") || isType(type, "minf") || isType(type, "stbl")
+                || isType(type, "sv3d") || isType(type, "proj")) {
+            parseMP4Boxes(payload, payloadSize, depth + 1, false, tracks);
+        } else if (tracks.isEmpty()) {
+            continue;
+        } else if (isType(type, "hdlr") && payloadSize >= 12) {
+            tracks.last().isVideo = isType(payload + 8, "vide");
+        } else if (isType(type, "stsd") && payloadSize >= 8) {
+            parseMP4Boxes(payload + 8, payloadSize - 8, depth + 1, true, tracks);
+        } else if (isType(type, "st3d") && payloadSize >= 5) {
+            switch (payload[4]) {
+            case 0:
+                tracks.last().inputMode = Input_Mono;
+                break;
+            case 1:
+                tracks.last().inputMode = Input_Top_Bottom;
+                break;
+            case 2:
+                tracks.last().inputMode = Input_Left_Right;
+                break;
+            case 4:
+                tracks.last().inputMode = Input_Right_Left;
+                break;
+            }
+        } else if (isType(type, "equi")) {
+            tracks.last().equirectangular = true;
+            tracks.last().halfEquirectangular = isHalfEquirectangular(payload, payloadSize);
+        }
+    }
+}
+
+bool probeMP4(const uchar* data, qint64 size, QList<Track>& tracks)
+{
+    if (size < 8)
+        return false;
+    const uchar* type = data + 4;
+    if (!isType(type, "ftyp") && !isType(type, "moov") && !isType(type, "mdat")
+            && !isType(type, "free") && !isType(type, "skip") && !isType(type, "wide"))
+        return false;
+    parseMP4Boxes(data, size, 0, false, tracks);
+    return !tracks.isEmpty();
+}
+
+/* Matroska / WebM: EBML elements; see RFC 9559 */
+
+bool readVint(const uchar* data, qint64 size, qint64& pos, quint64& value, bool keepMarker, bool* unknown = nullptr)
+{
+    if (pos >= size || data[pos] == 0)
+        return false;
+    int length = 1;
+    while (!(data[pos] & (0x80 >> (length - 1))))
+        length++;
+    if (pos + length > size)
+        return false;
+    value = keepMarker ? data[pos] : (data[pos] & (0xff >> length));
+    bool allOnes = ((data[pos] & (0xff >> length)) == (0xff >> length));
+    for (int i = 1; i < length; i++) {
+        value = (value << 8) | data[pos + i];
+        allOnes = allOnes && data[pos + i] == 0xff;
+    }
+    if (unknown)
+        *unknown = allOnes;
+    pos += length;
+    return true;
+}
+
+quint64 readUInt(const uchar* data, qint64 size)
+{
+    quint64 value = 0;
+    for (qint64 i = 0; i < size && i < 8; i++)
+        value = (value << 8) | data[i];
+    return value;
+}
+
+// returns false when parsing should stop (error or first Cluster reached)
+bool parseMatroskaElements(const uchar* data, qint64 size, int depth, QList<Track>& tracks, bool& haveTracks)
+{
+    qint64 pos = 0;
+    while (pos < size) {
+        quint64 id, elementSize;
+        bool unknownSize;
+        if (!readVint(data, size, pos, id, true) || !readVint(data, size, pos, elementSize, false, &unknownSize))
+            return false;
+        if (id == 0x1F43B675) // Cluster: all track information comes before it
+            return false;
+        if (unknownSize) {
+            if (id != 0x18538067) // only the Segment may have an unknown size here
+                return false;
+            elementSize = size - pos;
+        }
+        if (elementSize > quint64(size - pos))
+            return false;
+        const uchar* payload = data + pos;
+        qint64 payloadSize = elementSize;
+        pos += payloadSize;
+        if (depth >= maxDepth)
+            continue;
+
+        if (id == 0x18538067 || id == 0xE0 || id == 0x7670) { // Segment, Video, Projection
+            if (!parseMatroskaElements(payload, payloadSize, depth + 1, tracks, haveTracks))
+                return false;
+        } else if (id == 0x1654AE6B) { // Tracks
+            haveTracks = true;
+            parseMatroskaElements(payload, payloadSize, depth + 1, tracks, haveTracks);
+            return false; // nothing else of interest
+        } else if (id == 0xAE) { // TrackEntry
+            tracks.append(Track());
+            parseMatroskaElements(payload, payloadSize, depth + 1, tracks, haveTracks);
+        } else if (tracks.isEmpty()) {
+            continue;
+        } else if (id == 0x83) { // TrackType
+            tracks.last().isVideo = (readUInt(payload, payloadSize) == 1);
+        } else if (id == 0x53B8) { // StereoMode
+            switch (readUInt(payload, payloadSize)) {
+            case 0:
+                tracks.last().inputMode = Input_Mono;
+                break;
+            case 1:
+                tracks.last().inputMode = Input_Left_Right;
+                break;
+            case 2:
+                tracks.last().inputMode = Input_Bottom_Top;
+                break;
+            case 3:
+                tracks.last().inputMode = Input_Top_Bottom;
+                break;
+            case 11:
+                tracks.last().inputMode = Input_Right_Left;
+                break;
+            case 13:
+                tracks.last().inputMode = Input_Alternating_LR;
+                break;
+            case 14:
+                tracks.last().inputMode = Input_Alternating_RL;
+                break;
+            }
+        } else if (id == 0x7671) { // ProjectionType
+            tracks.last().equirectangular = (readUInt(payload, payloadSize) == 1);
+        } else if (id == 0x7672) { // ProjectionPrivate
+            tracks.last().halfEquirectangular = isHalfEquirectangular(payload, payloadSize);
+        }
+    }
+    return true;
+}
+
+bool probeMatroska(const uchar* data, qint64 size, QList<Track>& tracks)
+{
+    if (size < 4 || qFromBigEndian<quint32>(data) != 0x1A45DFA3)
+        return false;
+    // skip the EBML header
+    qint64 pos = 0;
+    quint64 id, headerSize;
+    if (!readVint(data, size, pos, id, true) || !readVint(data, size, pos, headerSize, false)
+            || headerSize > quint64(size - pos))
+        return false;
+    pos += headerSize;
+    bool haveTracks = false;
+    parseMatroskaElements(data + pos, size - pos, 0, tracks, haveTracks);
+    return haveTracks;
+}
+
+/* ASF / WMV: header objects and the 3dtv.at stereo tags in the extended
+ * content description; see https://www.3dtv.at/Knowhow/StereoWmvSpec_en.aspx */
+
+const uchar asfHeaderGuid[16] = { 0x30, 0x26, 0xB2, 0x75, 0x8E, 0x66, 0xCF, 0x11,
+    0xA6, 0xD9, 0x00, 0xAA, 0x00, 0x62, 0xCE, 0x6C };
+const uchar asfStreamPropertiesGuid[16] = { 0x91, 0x07, 0xDC, 0xB7, 0xB7, 0xA9, 0xCF, 0x11,
+    0x8E, 0xE6, 0x00, 0xC0, 0x0C, 0x20, 0x53, 0x65 };
+const uchar asfVideoMediaGuid[16] = { 0xC0, 0xEF, 0x19, 0xBC, 0x4D, 0x5B, 0xCF, 0x11,
+    0xA8, 0xFD, 0x00, 0x80, 0x5F, 0x5C, 0x44, 0x2B };
+const uchar asfExtendedContentDescriptionGuid[16] = { 0x40, 0xA4, 0xD0, 0xD2, 0x07, 0xE3, 0xD2, 0x11,
+    0x97, 0xF0, 0x00, 0xA0, 0xC9, 0x5E, 0xA8, 0x50 };
+
+QString asfString(const uchar* data, qint64 size)
+{
+    QString s;
+    for (qint64 i = 0; i + 1 < size; i += 2) {
+        char16_t c = qFromLittleEndian<quint16>(data + i);
+        if (c == 0)
+            break;
+        s.append(QChar(c));
+    }
+    return s;
+}
+
+void parseASFExtendedContentDescription(const uchar* data, qint64 size, QMap<QString, QString>& tags)
+{
+    if (size < 2)
+        return;
+    int count = qFromLittleEndian<quint16>(data);
+    qint64 pos = 2;
+    for (int i = 0; i < count; i++) {
+        if (pos + 2 > size)
+            return;
+        qint64 nameLength = qFromLittleEndian<quint16>(data + pos);
+        pos += 2;
+        if (pos + nameLength + 4 > size)
+            return;
+        QString name = asfString(data + pos, nameLength);
+        pos += nameLength;
+        int valueType = qFromLittleEndian<quint16>(data + pos);
+        qint64 valueLength = qFromLittleEndian<quint16>(data + pos + 2);
+        pos += 4;
+        if (pos + valueLength > size)
+            return;
+        if (valueType == 0) // unicode string
+            tags.insert(name, asfString(data + pos, valueLength));
+        else if ((valueType == 2 || valueType == 3) && valueLength == 4) // bool, dword
+            tags.insert(name, QString::number(qFromLittleEndian<quint32>(data + pos)));
+        else if (valueType == 5 && valueLength == 2) // word
+            tags.insert(name, QString::number(qFromLittleEndian<quint16>(data + pos)));
+        pos += valueLength;
+    }
+}
+
+bool probeASF(const uchar* data, qint64 size, QList<Track>& tracks, InputMode& defaultInputMode)
+{
+    if (size < 30 || std::memcmp(data, asfHeaderGuid, 16) != 0)
+        return false;
+    qint64 headerSize = qFromLittleEndian<quint64>(data + 16);
+    if (headerSize < 30 || headerSize > size)
+        return false;
+    QMap<QString, QString> tags;
+    qint64 pos = 30;
+    while (pos + 24 <= headerSize) {
+        qint64 objectSize = qFromLittleEndian<quint64>(data + pos + 16);
+        if (objectSize < 24 || objectSize > headerSize - pos)
+            break;
+        const uchar* payload = data + pos + 24;
+        qint64 payloadSize = objectSize - 24;
+        if (std::memcmp(data + pos, asfStreamPropertiesGuid, 16) == 0 && payloadSize >= 16) {
+            if (std::memcmp(payload, asfVideoMediaGuid, 16) == 0) {
+                tracks.append(Track());
+                tracks.last().isVideo = true;
+            }
+        } else if (std::memcmp(data + pos, asfExtendedContentDescriptionGuid, 16) == 0) {
+            parseASFExtendedContentDescription(payload, payloadSize, tags);
+        }
+        pos += objectSize;
+    }
+    // same interpretation as for the ffprobe output in metadata.cpp
+    QString layout = tags.value("StereoscopicLayout");
+    QString halfWidth = tags.value("StereoscopicHalfWidth");
+    QString halfHeight = tags.value("StereoscopicHalfHeight");
+    if (layout == "SideBySideRF")
+        defaultInputMode = (halfWidth == "1") ? Input_Right_Left_Half : Input_Right_Left;
+    else if (layout == "SideBySideLF")
+        defaultInputMode = (halfWidth == "1") ? Input_Left_Right_Half : Input_Left_Right;
+    else if (layout == "OverUnderRT")
+        defaultInputMode = (halfHeight == "1") ? Input_Bottom_Top_Half : Input_Bottom_Top;
+    else if (layout == "OverUnderLT")
+        defaultInputMode = (halfHeight == "1") ? Input_Top_Bottom_Half : Input_Top_Bottom;
+    return true;
+}
+
+}
+
+bool probeContainer(const QString& fileName,
+        InputMode& defaultInputMode, SurroundMode& defaultSurroundMode,
+        QList<InputMode>& inputModes, QList<SurroundMode>& surroundModes)
+{
+    QFile file(fileName);
+    if (!file.open(QIODeviceBase::ReadOnly) || file.size() <= 0)
+        return false;
+    qint64 size = file.size();
+    const uchar* data = file.map(0, size);
+    if (!data)
+        return false;
+
+    QList<Track> tracks;
+    InputMode newDefaultInputMode = defaultInputMode;
+    bool ok = probeMP4(data, size, tracks)
+        || probeMatroska(data, size, tracks)
+        || probeASF(data, size, tracks, newDefaultInputMode);
+    if (!ok) {
+        LOG_DEBUG("container probe: unsupported format or cannot parse %s", qPrintable(fileName));
+        return false;
+    }
+
+    defaultInputMode = newDefaultInputMode;
+    for (const Track& track : tracks) {
+        if (!track.isVideo)
+            continue;
+        inputModes.append(track.inputMode != Input_Unknown ? track.inputMode : defaultInputMode);
+        if (track.equirectangular)
+            surroundModes.append(track.halfEquirectangular ? Surround_180 : Surround_360);
+        else
+            surroundModes.append(defaultSurroundMode);
+        LOG_DEBUG("meta data from container for video stream %d: input mode %s, surround mode %s",
+                int(inputModes.size() - 1),
+                inputModeToString(inputModes.last()), surroundModeToString(surroundModes.last()));
+    }
+    return true;
+}
@@ -0,0 +1,38 @@
+/*
+ * This file is part of Bino, a 3D video player.
+ *
+ * Copyright (C) 2026
+ * Martin Lambers <marlam@marlam.de>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QString>
+#include <QList>
+
+#include "modes.hpp"
+
+
+/* Read stereo layout and projection directly from the container of a local
+ * file, without decoding anything: MP4/MOV (st3d, sv3d/proj), Matroska/WebM
+ * (StereoMode, Projection) and ASF/WMV (3dtv.at tags).
+ * Like the ffprobe based detection, this may change the default modes and
+ * appends one entry per video stream to the inputModes and surroundModes lists.
+ * Returns false if the container format is not supported or the file cannot
+ * be parsed; the lists are unchanged in that case. */
+bool probeContainer(const QString& fileName,
+        InputMode& defaultInputMode, SurroundMode& defaultSurroundMode,
+        QList<InputMode>& inputModes, QList<SurroundMode>& surroundModes);
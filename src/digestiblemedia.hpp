@@ -1,7 +1,7 @@
 /*
  * This file is part of Bino, a 3D video player.
  *
- * Copyright (C) 2024
+ * Copyright (C) 2024, 2026
  * Martin Lambers <marlam@marlam.de>
  *
  * This program is free software; you can redistribute it and/or modify
@@ -21,6 +21,10 @@
 #pragma once
 
 #include <QUrl>
+#include <QImage>
 
 
-QUrl digestibleMediaUrl(const QUrl& url);
+/* Decode a still image (JPEG, PNG, MPO) from the given data. Both images of
+ * an MPO are stacked top-bottom. Returns a null image on failure.
+ * This is thread-safe. */
+QImage decodeStillImage(const QUrl& url, const QByteArray& data);
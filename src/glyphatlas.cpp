@@ -0,0 +1,174 @@
+/*
+ * This file is part of Bino, a 3D video player.
+ *
+ * Copyright (C) 2026
+ * Martin Lambers <marlam@marlam.de>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+#include "glyphatlas.hpp"
+#include "log.hpp"
+
+
+GlyphAtlas::GlyphAtlas() :
+    _img(size, size, QImage::Format_Grayscale8),
+    _generation(0)
+{
+    clear();
+}
+
+void GlyphAtlas::clear()
+{
+    _img.fill(0);
+    _glyphs.clear();
+    _shelfX = 0;
+    _shelfY = 0;
+    _shelfHeight = 0;
+    _dirtyRect = _img.rect();
+    _generation++;
+}
+
+/* Squared Euclidean distance transform of a sampled function in one dimension,
+ * see Felzenszwalb and Huttenlocher, Distance Transforms of Sampled Functions,
+ * Theory of Computing 8, 2012. */
+static void distanceTransform1D(const float* f, int n, float* d, int* v, float* z)
+{
+    const float inf = std::numeric_limits<float>::max();
+    int k = 0;
+    v[0] = 0;
+    z[0] = -inf;
+    z[1] = +inf;
+    for (int q = 1; q < n; q++) {
+        float s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * (q - v[k]));
+        while (s <= z[k]) {
+            k--;
+            s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * (q - v[k]));
+        }
+        k++;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = +inf;
+    }
+    k = 0;
+    for (int q = 0; q < n; q++) {
+        while (z[k + 1] < q)
+            k++;
+        d[q] = (q - v[k]) * (q - v[k]) + f[v[k]];
+    }
+}
+
+/* Squared distance of each pixel to the nearest pixel for which inside is the given value */
+static std::vector<float> squaredDistances(const std::vector<bool>& inside, int w, int h, bool value)
+{
+    const float inf = 1e20f;
+    int n = std::max(w, h);
+    std::vector<float> f(n), d(n), z(n + 1);
+    std::vector<int> v(n);
+    std::vector<float> grid(w * h);
+    for (int i = 0; i < w * h; i++)
+        grid[i] = (inside[i] == value ? 0.0f : inf);
+    for (int x = 0; x < w; x++) {
+        for (int y = 0; y < h; y++)
+            f[y] = grid[y * w + x];
+        distanceTransform1D(f.data(), h, d.data(), v.data(), z.data());
+        for (int y = 0; y < h; y++)
+            grid[y * w + x] = d[y];
+    }
+    for (int y = 0; y < h; y++) {
+        distanceTransform1D(grid.data() + y * w, w, d.data(), v.data(), z.data());
+        std::copy(d.begin(), d.begin() + w, grid.begin() + y * w);
+    }
+    return grid;
+}
+
+void GlyphAtlas::computeDistanceField(const QImage& alphaMap, int x, int y, int w, int h)
+{
+    // alphaMap is placed at (spread, spread) in the w x h cell
+    std::vector<bool> inside(w * h, false);
+    for (int ay = 0; ay < alphaMap.height(); ay++) {
+        const uchar* line = alphaMap.constScanLine(ay);
+        for (int ax = 0; ax < alphaMap.width(); ax++)
+            inside[(ay + spread) * w + (ax + spread)] = (line[ax] >= 128);
+    }
+    std::vector<float> toInside = squaredDistances(inside, w, h, true);
+    std::vector<float> toOutside = squaredDistances(inside, w, h, false);
+    for (int cy = 0; cy < h; cy++) {
+        uchar* line = _img.scanLine(y + cy) + x;
+        for (int cx = 0; cx < w; cx++) {
+            int i = cy * w + cx;
+            // distance to the edge between pixel centers; positive outside
+            float distance = inside[i]
+                ? -(std::sqrt(toOutside[i]) - 0.5f)
+                : +(std::sqrt(toInside[i]) - 0.5f);
+            float value = 0.5f - distance / (2.0f * spread);
+            line[cx] = std::clamp(int(value * 255.0f + 0.5f), 0, 255);
+        }
+    }
+}
+
+bool GlyphAtlas::glyph(const QRawFont& font, quint32 glyphIndex, Glyph* glyph)
+{
+    QPair<QString, quint32> key(font.familyName() + '\n' + font.styleName(), glyphIndex);
+    auto it = _glyphs.constFind(key);
+    if (it != _glyphs.constEnd()) {
+        *glyph = it.value();
+        return true;
+    }
+
+    QRawFont baseFont(font);
+    baseFont.setPixelSize(baseSize);
+    QImage alphaMap = baseFont.alphaMapForGlyph(glyphIndex, QRawFont::PixelAntialiasing);
+    // the values of Indexed8 alpha maps are their indices
+    if (alphaMap.format() != QImage::Format_Alpha8
+            && alphaMap.format() != QImage::Format_Grayscale8
+            && alphaMap.format() != QImage::Format_Indexed8) {
+        alphaMap = alphaMap.convertToFormat(QImage::Format_Alpha8);
+    }
+    int w = alphaMap.width() + 2 * spread;
+    int h = alphaMap.height() + 2 * spread;
+    Glyph g;
+    if (alphaMap.isNull() || alphaMap.width() == 0 || alphaMap.height() == 0 || w > size || h > size) {
+        // whitespace, or too large to be a useful subtitle glyph
+        _glyphs.insert(key, g);
+        *glyph = g;
+        return true;
+    }
+
+    if (_shelfX + w > size) {
+        _shelfX = 0;
+        _shelfY += _shelfHeight;
+        _shelfHeight = 0;
+    }
+    if (_shelfY + h > size) {
+        LOG_DEBUG("glyph atlas is full after %d glyphs", int(_glyphs.size()));
+        return false;
+    }
+    computeDistanceField(alphaMap, _shelfX, _shelfY, w, h);
+    // the alpha map starts at the pixel that contains the top left bounding box corner
+    QRectF bounds = baseFont.boundingRect(glyphIndex);
+    g.rect = QRectF(std::floor(bounds.x()) - spread, std::floor(bounds.y()) - spread, w, h);
+    g.atlasRect = QRectF(float(_shelfX) / size, float(_shelfY) / size, float(w) / size, float(h) / size);
+    _dirtyRect |= QRect(_shelfX, _shelfY, w, h);
+    _shelfX += w;
+    _shelfHeight = std::max(_shelfHeight, h);
+    _glyphs.insert(key, g);
+    *glyph = g;
+    return true;
+}
@@ -0,0 +1,87 @@
+/*
+ * This file is part of Bino, a 3D video player.
+ *
+ * Copyright (C) 2026
+ * Martin Lambers <marlam@marlam.de>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QImage>
+#include <QRawFont>
+#include <QHash>
+#include <QPair>
+#include <QRectF>
+
+
+/* A cache of glyphs as signed distance fields in a single-channel texture
+ * image. Each glyph is rasterized once at a base size and can then be
+ * drawn sharply at any size by thresholding the interpolated distance.
+ * Glyphs are packed into shelves; when the atlas is full, it is cleared
+ * and its generation changes, which invalidates all glyph data obtained
+ * from it before. */
+class GlyphAtlas
+{
+public:
+    static const int size = 1024;   // width and height of the atlas image
+    static const int baseSize = 64; // pixel size of the rasterized glyphs
+    static const int spread = 8;    // maximum distance in base size pixels
+
+    struct Glyph
+    {
+        QRectF rect;        // relative to the pen position, in base size pixels, y down; empty for whitespace
+        QRectF atlasRect;   // in texture coordinates
+    };
+
+private:
+    QImage _img;
+    QHash<QPair<QString, quint32>, Glyph> _glyphs;
+    int _shelfX, _shelfY, _shelfHeight;
+    QRect _dirtyRect;
+    unsigned int _generation;
+
+    void computeDistanceField(const QImage& alphaMap, int x, int y, int w, int h);
+
+public:
+    GlyphAtlas();
+
+    /* Get the glyph with the given index from the given font (its size does not
+     * matter). Returns false if the atlas is full; call clear() and start over. */
+    bool glyph(const QRawFont& font, quint32 glyphIndex, Glyph* glyph);
+
+    void clear();
+
+    unsigned int generation() const
+    {
+        return _generation;
+    }
+
+    const QImage& image() const
+    {
+        return _img;
+    }
+
+    /* The part of the image that changed since the last call of resetDirtyRect() */
+    const QRect& dirtyRect() const
+    {
+        return _dirtyRect;
+    }
+
+    void resetDirtyRect()
+    {
+        _dirtyRect = QRect();
+    }
+};
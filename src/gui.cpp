@@ -698,7 +698,17 @@ void Gui::playlistLoad()
     QString name = QFileDialog::getOpenFileName(this, QString(), lastOpenDir, tr("Playlists (*.m3u)"));
     if (!name.isEmpty()) {
         QString errStr;
-        if (!Playlist::instance()->load(name, errStr)) {
+        QProgressDialog progressDialog(tr("Loading playlist..."), QString(), 0, 100, this);
+        progressDialog.setWindowModality(Qt::WindowModal);
+        progressDialog.setMinimumDuration(500);
+        QMetaObject::Connection connection = connect(Playlist::instance(), &Playlist::progress,
+                [&](qint64 done, qint64 total) {
+                progressDialog.setValue(total > 0 ? int(done * 100 / total) : 100);
+                });
+        bool ok = Playlist::instance()->load(name, errStr);
+        disconnect(connection);
+        progressDialog.reset();
+        if (!ok) {
             QMessageBox::critical(this, tr("Error"), errStr);
         } else {
             settings.setValue("Directory", QFileInfo(name).absolutePath());
@@ -0,0 +1,391 @@
+/*
+ * This file is part of Bino, a 3D video player.
+ *
+ * Copyright (C) 2026
+ * Martin Lambers <marlam@marlam.de>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+
+#include <QCoreApplication>
+#include <QMatrix4x4>
+#include <QtMath>
+
+#include "headless.hpp"
+#include "bino.hpp"
+#include "tools.hpp"
+#include "trace.hpp"
+#include "log.hpp"
+
+
+Headless::Headless(OutputMode outputMode, int width, int height, Format format) :
+    _outputMode(outputMode),
+    _width(width), _height(height),
+    _format(format),
+    _finished(false),
+    _pboIndex(0),
+    _framesWritten(0)
+{
+    _pboPending[0] = false;
+    _pboPending[1] = false;
+}
+
+Headless::~Headless()
+{
+    finish();
+}
+
+bool Headless::init(const QString& fileName)
+{
+    // Open the output
+    bool ok;
+    if (fileName == "-")
+        ok = _file.open(stdout, QIODeviceBase::WriteOnly);
+    else {
+        _file.setFileName(fileName);
+        ok = _file.open(QIODeviceBase::WriteOnly | QIODeviceBase::Truncate);
+    }
+    if (!ok) {
+        LOG_FATAL("%s", qPrintable(tr("Cannot open %1: %2").arg(fileName).arg(_file.errorString())));
+        return false;
+    }
+    if (_format == Format_Y4M) {
+        // The frame rate is nominal: frames are written as they are displayed.
+        QByteArray header = QString("YUV4MPEG2 W%1 H%2 F25:1 Ip A1:1 C444 XCOLORRANGE=LIMITED\n")
+            .arg(_width).arg(_height).toLatin1();
+        if (_file.write(header) != header.size()) {
+            LOG_FATAL("%s", qPrintable(tr("Cannot write %1: %2").arg(fileName).arg(_file.errorString())));
+            return false;
+        }
+    }
+
+    // Create the offscreen OpenGL context
+    _surface.setFormat(QSurfaceFormat::defaultFormat());
+    _surface.create();
+    _context.setFormat(QSurfaceFormat::defaultFormat());
+    if (!_context.create() || !_surface.isValid() || !_context.makeCurrent(&_surface)
+            || _context.format().majorVersion() < 3) {
+        LOG_FATAL("%s", qPrintable(tr("Cannot create offscreen OpenGL context.")));
+        return false;
+    }
+    initializeOpenGLFunctions();
+    LOG_INFO("OpenGL Version:      %s", getOpenGLString(this, GL_VERSION));
+    LOG_INFO("OpenGL Renderer:     %s", getOpenGLString(this, GL_RENDERER));
+    GLint maxTexSize;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTexSize);
+    if (_width > maxTexSize || _height > maxTexSize) {
+        LOG_FATAL("%s", qPrintable(tr("Output size %1x%2 is not supported by OpenGL.").arg(_width).arg(_height)));
+        return false;
+    }
+
+    // View textures
+    glGenTextures(2, _viewTex);
+    for (int i = 0; i < 2; i++) {
+        glBindTexture(GL_TEXTURE_2D, _viewTex[i]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        _viewTexWidth[i] = -1;
+        _viewTexHeight[i] = -1;
+    }
+    CHECK_GL();
+
+    // Output framebuffer
+    glGenTextures(1, &_outputTex);
+    glBindTexture(GL_TEXTURE_2D, _outputTex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, _width, _height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glGenFramebuffers(1, &_outputFbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, _outputFbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _outputTex, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        LOG_FATAL("%s", qPrintable(tr("Cannot create offscreen framebuffer.")));
+        return false;
+    }
+    CHECK_GL();
+
+    // Pixel buffer objects for asynchronous read back
+    glGenBuffers(2, _pbos);
+    for (int i = 0; i < 2; i++) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, _pbos[i]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, qsizetype(_width) * _height * 4, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    CHECK_GL();
+
+    // Quad geometry
+    const float quadPositions[] = {
+        -1.0f, +1.0f, 0.0f,
+        +1.0f, +1.0f, 0.0f,
+        +1.0f, -1.0f, 0.0f,
+        -1.0f, -1.0f, 0.0f
+    };
+    const float quadTexCoords[] = {
+        0.0f, 1.0f,
+        1.0f, 1.0f,
+        1.0f, 0.0f,
+        0.0f, 0.0f
+    };
+    static const unsigned short quadIndices[] = {
+        0, 3, 1, 1, 3, 2
+    };
+    glGenVertexArrays(1, &_quadVao);
+    glBindVertexArray(_quadVao);
+    GLuint quadPositionBuf;
+    glGenBuffers(1, &quadPositionBuf);
+    glBindBuffer(GL_ARRAY_BUFFER, quadPositionBuf);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quadPositions), quadPositions, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
+    glEnableVertexAttribArray(0);
+    GLuint quadTexCoordBuf;
+    glGenBuffers(1, &quadTexCoordBuf);
+    glBindBuffer(GL_ARRAY_BUFFER, quadTexCoordBuf);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quadTexCoords), quadTexCoords, GL_STATIC_DRAW);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, 0);
+    glEnableVertexAttribArray(1);
+    GLuint quadIndexBuf;
+    glGenBuffers(1, &quadIndexBuf);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadIndexBuf);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(quadIndices), quadIndices, GL_STATIC_DRAW);
+    CHECK_GL();
+
+    // Initialize Bino
+    if (!Bino::instance()->initProcess())
+        return false;
+    // every frame is rendered only once, so very large frames must be converted completely
+    Bino::instance()->setTileConversionBudget(-1);
+
+    _outputBuffer.resize(qsizetype(_width) * _height * 3);
+    connect(Bino::instance(), &Bino::newVideoFrame, this, &Headless::renderFrame);
+    return true;
+}
+
+void Headless::rebuildDisplayPrgIfNecessary(OutputMode outputMode)
+{
+    if (outputMode == Output_Right)
+        outputMode = Output_Left; // these are handled specially; see shader
+    if (_displayPrg.isLinked() && _displayPrgOutputMode == outputMode)
+        return;
+
+    LOG_DEBUG("rebuilding headless display program for output mode %s", outputModeToString(outputMode));
+    QString vertexShaderSource = readFile(":src/shader-display.vert.glsl");
+    QString fragmentShaderSource = readFile(":src/shader-display.frag.glsl");
+    fragmentShaderSource.replace("$OUTPUT_MODE", QString::number(int(outputMode)));
+    if (OpenGLType != OpenGL_Type_Desktop) {
+        vertexShaderSource.prepend("#version 300 es\n");
+        fragmentShaderSource.prepend("#version 300 es\n"
+                "precision mediump float;\n");
+    } else {
+        vertexShaderSource.prepend("#version 330\n");
+        fragmentShaderSource.prepend("#version 330\n");
+    }
+    _displayPrg.removeAllShaders();
+    _displayPrg.addShaderFromSourceCode(QOpenGLShader::Vertex, vertexShaderSource);
+    _displayPrg.addShaderFromSourceCode(QOpenGLShader::Fragment, fragmentShaderSource);
+    _displayPrg.link();
+    _displayPrgOutputMode = outputMode;
+}
+
+void Headless::renderFrame()
+{
+    if (_finished)
+        return;
+    _context.makeCurrent(&_surface);
+
+    // Find out about the views we have
+    int viewCount, viewWidth, viewHeight;
+    float frameDisplayAspectRatio;
+    bool surround;
+    Bino::instance()->updateMainProcess();
+    Bino::instance()->preRenderProcess(_width, _height, &viewCount, &viewWidth, &viewHeight, &frameDisplayAspectRatio, &surround);
+
+    // Adjust the stereo mode if necessary
+    bool frameIsStereo = (viewCount == 2);
+    OutputMode outputMode = _outputMode;
+    if (!frameIsStereo)
+        outputMode = Output_Left;
+    if (outputMode == Output_Left_Right || outputMode == Output_Right_Left)
+        frameDisplayAspectRatio *= 2.0f;
+    else if (outputMode == Output_Top_Bottom || outputMode == Output_Bottom_Top || outputMode == Output_HDMI_Frame_Pack)
+        frameDisplayAspectRatio *= 0.5f;
+    LOG_FIREHOSE("%s: %d views, %dx%d, %g, surround %s", Q_FUNC_INFO, viewCount, viewWidth, viewHeight, frameDisplayAspectRatio, surround ? "on" : "off");
+
+    // Fill the view textures. Surround views use the default orientation.
+    for (int v = 0; v <= 1; v++) {
+        if ((outputMode == Output_Left && v == 1) || (outputMode == Output_Right && v == 0))
+            continue;
+        glBindTexture(GL_TEXTURE_2D, _viewTex[v]);
+        if (_viewTexWidth[v] != viewWidth || _viewTexHeight[v] != viewHeight) {
+            if (OpenGLType == OpenGL_Type_Desktop)
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16, viewWidth, viewHeight, 0, GL_RGBA, GL_UNSIGNED_SHORT, nullptr);
+            else
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB10_A2, viewWidth, viewHeight, 0, GL_RGBA, GL_UNSIGNED_INT_2_10_10_10_REV, nullptr);
+            _viewTexWidth[v] = viewWidth;
+            _viewTexHeight[v] = viewHeight;
+        }
+        QMatrix4x4 projectionMatrix;
+        if (surround) {
+            float top = qTan(qDegreesToRadians(50.0f) * 0.5f);
+            float right = top * 2.0f; // always 2:1 for surround video!
+            projectionMatrix.frustum(-right, right, -top, top, 1.0f, 100.0f);
+        }
+        Bino::instance()->render(
+                QVector3D(), QVector3D(), QVector3D(), QVector3D(), QVector3D(), QVector3D(),
+                projectionMatrix, QMatrix4x4(), QMatrix4x4(), v, viewWidth, viewHeight, _viewTex[v]);
+        glBindTexture(GL_TEXTURE_2D, _viewTex[v]);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+
+    // Compose the views into output frames. Modes that show the views one after the
+    // other on a display produce one output frame per view.
+    if (outputMode == Output_OpenGL_Stereo || outputMode == Output_Alternating) {
+        rebuildDisplayPrgIfNecessary(Output_Left /* also covers Output_Right */);
+        renderOutputFrame(frameDisplayAspectRatio, 0);
+        renderOutputFrame(frameDisplayAspectRatio, 1);
+    } else {
+        rebuildDisplayPrgIfNecessary(outputMode);
+        renderOutputFrame(frameDisplayAspectRatio, outputMode == Output_Right ? 1 : 0);
+    }
+}
+
+void Headless::renderOutputFrame(float frameDisplayAspectRatio, int outputModeLeftRightView)
+{
+    TRACE_SCOPE("display composition", Bino::instance()->frameId());
+    glBindFramebuffer(GL_FRAMEBUFFER, _outputFbo);
+    glViewport(0, 0, _width, _height);
+    glDisable(GL_DEPTH_TEST);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    float relWidth = 1.0f;
+    float relHeight = 1.0f;
+    float screenAspectRatio = _width / float(_height);
+    if (_outputMode == Output_HDMI_Frame_Pack)
+        screenAspectRatio = _width / (_height - _height / 49.0f);
+    if (screenAspectRatio < frameDisplayAspectRatio)
+        relHeight = screenAspectRatio / frameDisplayAspectRatio;
+    else
+        relWidth = frameDisplayAspectRatio / screenAspectRatio;
+    glUseProgram(_displayPrg.programId());
+    _displayPrg.setUniformValue("view0", 0);
+    _displayPrg.setUniformValue("view1", 1);
+    _displayPrg.setUniformValue("relativeWidth", relWidth);
+    _displayPrg.setUniformValue("relativeHeight", relHeight);
+    _displayPrg.setUniformValue("fragOffsetX", 0.0f);
+    _displayPrg.setUniformValue("fragOffsetY", 0.0f);
+    _displayPrg.setUniformValue("outputModeLeftRightView", outputModeLeftRightView);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, _viewTex[0]);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, _viewTex[1]);
+    glBindVertexArray(_quadVao);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, 0);
+    readBack();
+}
+
+void Headless::readBack()
+{
+    TRACE_SCOPE("read back", Bino::instance()->frameId());
+    // Start the transfer of the current frame into one PBO...
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, _outputFbo);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, _pbos[_pboIndex]);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, _width, _height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    _pboPending[_pboIndex] = true;
+    // ... and write the previous frame from the other PBO while that happens.
+    int previous = (_pboIndex == 0 ? 1 : 0);
+    if (_pboPending[previous])
+        writePbo(previous);
+    _pboIndex = previous;
+}
+
+bool Headless::writePbo(int index)
+{
+    _pboPending[index] = false;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, _pbos[index]);
+    const unsigned char* pixels = static_cast<const unsigned char*>(glMapBufferRange(
+                GL_PIXEL_PACK_BUFFER, 0, qsizetype(_width) * _height * 4, GL_MAP_READ_BIT));
+    if (!pixels) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        LOG_WARNING("%s", qPrintable(tr("Cannot map pixel buffer; dropping frame")));
+        return false;
+    }
+    unsigned char* out = reinterpret_cast<unsigned char*>(_outputBuffer.data());
+    const qsizetype planeSize = qsizetype(_width) * _height;
+    for (int y = 0; y < _height; y++) {
+        // OpenGL rows are bottom-up
+        const unsigned char* src = pixels + qsizetype(_height - 1 - y) * _width * 4;
+        if (_format == Format_RGB) {
+            unsigned char* dst = out + qsizetype(y) * _width * 3;
+            for (int x = 0; x < _width; x++) {
+                dst[3 * x + 0] = src[4 * x + 0];
+                dst[3 * x + 1] = src[4 * x + 1];
+                dst[3 * x + 2] = src[4 * x + 2];
+            }
+        } else {
+            // BT.709, limited range
+            unsigned char* dstY = out + qsizetype(y) * _width;
+            unsigned char* dstU = dstY + planeSize;
+            unsigned char* dstV = dstU + planeSize;
+            for (int x = 0; x < _width; x++) {
+                float r = src[4 * x + 0];
+                float g = src[4 * x + 1];
+                float b = src[4 * x + 2];
+                float l = 0.2126f * r + 0.7152f * g + 0.0722f * b;
+                dstY[x] = qBound(0, qRound(16.0f + l * (219.0f / 255.0f)), 255);
+                dstU[x] = qBound(0, qRound(128.0f + (b - l) / 1.8556f * (224.0f / 255.0f)), 255);
+                dstV[x] = qBound(0, qRound(128.0f + (r - l) / 1.5748f * (224.0f / 255.0f)), 255);
+            }
+        }
+    }
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    bool ok = true;
+    if (_format == Format_Y4M)
+        ok = (_file.write("FRAME\n", 6) == 6);
+    ok = ok && (_file.write(_outputBuffer) == _outputBuffer.size());
+    if (!ok) {
+        LOG_FATAL("%s", qPrintable(tr("Cannot write output frame: %1").arg(_file.errorString())));
+        _finished = true;
+        _file.close();
+        QCoreApplication::exit(1);
+        return false;
+    }
+    _framesWritten++;
+    LOG_FIREHOSE("headless: wrote output frame %lld", _framesWritten);
+    return true;
+}
+
+void Headless::finish()
+{
+    if (_finished)
+        return;
+    _finished = true;
+    if (_context.isValid() && _context.makeCurrent(&_surface)) {
+        // the most recent frame is the one that was read back last
+        int last = (_pboIndex == 0 ? 1 : 0);
+        if (_pboPending[last])
+            writePbo(last);
+    }
+    if (_file.isOpen()) {
+        _file.flush();
+        _file.close();
+    }
+    LOG_INFO("headless: %lld output frames written", _framesWritten);
+}
@@ -0,0 +1,82 @@
+/*
+ * This file is part of Bino, a 3D video player.
+ *
+ * Copyright (C) 2026
+ * Martin Lambers <marlam@marlam.de>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLShaderProgram>
+#include <QFile>
+
+#include "modes.hpp"
+
+
+/* Headless mode: render without any window into an offscreen framebuffer
+ * and write the composed output frames to a file or to stdout.
+ * The read back is asynchronous: the pixels of frame N are transferred
+ * into a pixel buffer object while frame N-1 is written. */
+class Headless : public QObject, protected QOpenGLExtraFunctions
+{
+Q_OBJECT
+
+public:
+    enum Format {
+        Format_RGB,     // raw 8 bit RGB, one frame after the other
+        Format_Y4M      // YUV4MPEG2 with 4:4:4 chroma
+    };
+
+private:
+    OutputMode _outputMode;
+    int _width, _height;
+    Format _format;
+    QOffscreenSurface _surface;
+    QOpenGLContext _context;
+    QFile _file;
+    bool _finished;
+
+    unsigned int _viewTex[2];
+    int _viewTexWidth[2], _viewTexHeight[2];
+    unsigned int _quadVao;
+    unsigned int _outputFbo;
+    unsigned int _outputTex;
+    unsigned int _pbos[2];
+    bool _pboPending[2];
+    int _pboIndex;
+    QOpenGLShaderProgram _displayPrg;
+    int _displayPrgOutputMode;
+    QByteArray _outputBuffer;
+    long long _framesWritten;
+
+    void rebuildDisplayPrgIfNecessary(OutputMode outputMode);
+    void renderOutputFrame(float frameDisplayAspectRatio, int outputModeLeftRightView);
+    void readBack();
+    bool writePbo(int index);
+
+public:
+    Headless(OutputMode outputMode, int width, int height, Format format);
+    virtual ~Headless();
+
+    bool init(const QString& fileName); // "-" means stdout
+
+public slots:
+    void renderFrame();
+    void finish();
+};
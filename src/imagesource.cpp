@@ -0,0 +1,297 @@
+/*
+ * This file is part of Bino, a 3D video player.
+ *
+ * Copyright (C) 2026
+ * Martin Lambers <marlam@marlam.de>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <algorithm>
+
+#include <QFile>
+#include <QThread>
+#include <QImage>
+#include <QVideoFrameFormat>
+#include <QtVersion>
+
+#include "imagesource.hpp"
+#include "digestiblemedia.hpp"
+#include "urlloader.hpp"
+#include "tools.hpp"
+#include "log.hpp"
+
+
+ImageSource::ImageSource(QObject* parent) : QObject(parent),
+    _videoSink(nullptr),
+    _loader(nullptr),
+    _frameIsReady(false),
+    _state(Stopped),
+    _duration(0),
+    _remaining(0),
+    _cacheSize(0),
+    _cacheBudget(qint64(512) * 1024 * 1024)
+{
+    _threadPool.setMaxThreadCount(std::max(2, QThread::idealThreadCount()));
+    _durationTimer.setSingleShot(true);
+    connect(&_durationTimer, &QTimer::timeout, [=]() { durationElapsed(); });
+}
+
+ImageSource::~ImageSource()
+{
+    delete _loader;
+    _threadPool.waitForDone();
+}
+
+bool ImageSource::handles(const QUrl& url)
+{
+    QString extension = getExtension(url);
+    return (extension == "jpg" || extension == "jpeg"
+            || extension == "png"
+            || extension == "jps"
+            || extension == "pns"
+            || extension == "mpo");
+}
+
+QVideoFrame ImageSource::decode(const QUrl& url, const QByteArray& data)
+{
+    QImage img = decodeStillImage(url, data);
+    if (img.isNull())
+        return QVideoFrame();
+    // this format is handled by our texture upload without conversion
+    img.convertTo(QImage::Format_RGB32);
+#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
+    // the frame shares the image data
+    return QVideoFrame(img);
+#else
+    QVideoFrameFormat format(img.size(), QVideoFrameFormat::pixelFormatFromImageFormat(img.format()));
+    QVideoFrame frame(format);
+    if (!frame.map(QVideoFrame::WriteOnly))
+        return QVideoFrame();
+    for (int y = 0; y < img.height(); y++)
+        std::memcpy(frame.bits(0) + y * frame.bytesPerLine(0), img.constScanLine(y), img.width() * 4);
+    frame.unmap();
+    return frame;
+#endif
+}
+
+void ImageSource::setVideoSink(QVideoSink* sink)
+{
+    _videoSink = sink;
+}
+
+void ImageSource::setDuration(int milliseconds)
+{
+    _duration = milliseconds;
+}
+
+int ImageSource::duration() const
+{
+    return _duration;
+}
+
+static qint64 frameBytes(const QVideoFrame& frame)
+{
+    return qint64(frame.width()) * frame.height() * 4; // see decode()
+}
+
+void ImageSource::insertIntoCache(const QUrl& url, const QVideoFrame& frame)
+{
+    qint64 bytes = frameBytes(frame);
+    if (bytes > _cacheBudget || _cache.contains(url))
+        return;
+    while (_cacheSize + bytes > _cacheBudget && !_cacheLru.isEmpty()) {
+        QUrl oldestUrl = _cacheLru.takeFirst();
+        _cacheSize -= frameBytes(_cache.take(oldestUrl));
+        LOG_FIREHOSE("image source: evicted %s from cache", qPrintable(oldestUrl.toString()));
+    }
+    _cache.insert(url, frame);
+    _cacheLru.append(url);
+    _cacheSize += bytes;
+}
+
+void ImageSource::prefetch(const QList<QUrl>& urls)
+{
+    for (const QUrl& url : urls) {
+        // remote images are loaded only on demand
+        if (!url.isLocalFile() || !handles(url) || _cache.contains(url) || _pending.contains(url))
+            continue;
+        LOG_DEBUG("image source: prefetching %s", qPrintable(url.toString()));
+        startDecoding(url, QByteArray());
+    }
+}
+
+QVideoFrame ImageSource::cachedFrame(const QUrl& url) const
+{
+    return _cache.value(url);
+}
+
+void ImageSource::setSource(const QUrl& url)
+{
+    if (_loader) {
+        _loader->disconnect(this);
+        _loader->deleteLater();
+        _loader = nullptr;
+    }
+    _durationTimer.stop();
+    _frame = QVideoFrame();
+    _frameIsReady = false;
+    _source = url;
+    setState(Stopped);
+    if (url.isEmpty())
+        return;
+
+    auto it = _cache.find(url);
+    if (it != _cache.end()) {
+        LOG_DEBUG("image source: %s is in cache", qPrintable(url.toString()));
+        _cacheLru.removeOne(url);
+        _cacheLru.append(url);
+        _frame = it.value();
+        _frameIsReady = true;
+        emit frameReady();
+    } else if (_pending.contains(url)) {
+        LOG_DEBUG("image source: waiting for prefetched %s", qPrintable(url.toString()));
+    } else if (url.isLocalFile()) {
+        LOG_DEBUG("image source: loading %s", qPrintable(url.toString()));
+        startDecoding(url, QByteArray());
+    } else {
+        LOG_DEBUG("image source: loading %s", qPrintable(url.toString()));
+        _loader = new UrlLoader(url);
+        connect(_loader, &UrlLoader::finished, this, [=]() {
+                UrlLoader* loader = _loader;
+                _loader = nullptr;
+                loader->disconnect(this);
+                const QByteArray& data = loader->data();
+                if (data.isEmpty()) {
+                    loader->deleteLater();
+                    emit errorOccurred(tr("Cannot load %1").arg(url.toString()));
+                    return;
+                }
+                // the data may be a mapping of the cached file, which the loader owns
+                startDecoding(url, data, loader);
+                });
+        connect(_loader, &UrlLoader::progress, this, [=](qint64 received, qint64 total) {
+                LOG_FIREHOSE("image source: loaded %lld of %lld bytes of %s", received, total, qPrintable(url.toString()));
+                });
+        _loader->start();
+    }
+}
+
+void ImageSource::startDecoding(const QUrl& url, const QByteArray& data, UrlLoader* loader)
+{
+    // The loader must outlive the decoding since it owns the data. As our
+    // child it is deleted after the destructor waited for the thread pool.
+    if (loader)
+        loader->setParent(this);
+    // local files are mapped in the worker thread, too
+    _pending.insert(url);
+    _threadPool.start([this, url, data, loader]() {
+            QVideoFrame frame;
+            if (data.isEmpty()) {
+                QFile file(url.toLocalFile());
+                QByteArray mapped = mapFile(file);
+                if (!mapped.isEmpty())
+                    frame = decode(url, mapped);
+            } else {
+                frame = decode(url, data);
+            }
+            QMetaObject::invokeMethod(this, [this, url, frame, loader]() {
+                    delete loader;
+                    decodingFinished(url, frame);
+                    }, Qt::QueuedConnection);
+            });
+}
+
+void ImageSource::decodingFinished(const QUrl& url, const QVideoFrame& frame)
+{
+    _pending.remove(url);
+    if (frame.isValid())
+        insertIntoCache(url, frame);
+    if (url == _source && !_frameIsReady) {
+        if (!frame.isValid()) {
+            emit errorOccurred(tr("Cannot decode image %1").arg(url.toString()));
+        } else {
+            LOG_DEBUG("image source: %s is ready", qPrintable(url.toString()));
+            _frame = frame;
+            _frameIsReady = true;
+            emit frameReady();
+        }
+    }
+    if (frame.isValid())
+        emit prefetched(url);
+}
+
+QUrl ImageSource::source() const
+{
+    return _source;
+}
+
+ImageSource::State ImageSource::state() const
+{
+    return _state;
+}
+
+void ImageSource::present()
+{
+    if (_videoSink)
+        _videoSink->setVideoFrame(_frame);
+}
+
+void ImageSource::setState(State state)
+{
+    if (_state != state) {
+        _state = state;
+        emit stateChanged(state);
+    }
+}
+
+void ImageSource::play()
+{
+    if (!_frameIsReady || _state == Playing)
+        return;
+    if (_state == Stopped) {
+        present();
+        _remaining = _duration;
+    }
+    setState(Playing);
+    _playTimer.start();
+    _durationTimer.start(_remaining);
+}
+
+void ImageSource::pause()
+{
+    if (!_frameIsReady || _state == Paused)
+        return;
+    if (_state == Stopped) {
+        present();
+        _remaining = _duration;
+    } else {
+        _durationTimer.stop();
+        _remaining = std::max(0, int(_remaining - _playTimer.elapsed()));
+    }
+    setState(Paused);
+}
+
+void ImageSource::stop()
+{
+    _durationTimer.stop();
+    setState(Stopped);
+}
+
+void ImageSource::durationElapsed()
+{
+    setState(Stopped);
+    emit ended();
+}
@@ -0,0 +1,121 @@
+/*
+ * This file is part of Bino, a 3D video player.
+ *
+ * Copyright (C) 2026
+ * Martin Lambers <marlam@marlam.de>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QUrl>
+#include <QMap>
+#include <QSet>
+#include <QList>
+#include <QVideoFrame>
+#include <QVideoSink>
+#include <QThreadPool>
+#include <QTimer>
+#include <QElapsedTimer>
+
+class UrlLoader;
+
+
+/* A source for still images (JPEG, PNG, JPS, PNS, MPO) that does not use
+ * QMediaPlayer: the image is decoded on a worker thread directly into a
+ * QVideoFrame which is then handed to the video sink.
+ *
+ * The interface mimics the relevant parts of QMediaPlayer: setSource() starts
+ * loading and decoding, and frameReady() is emitted when the frame is ready to
+ * be shown. play() presents the frame and shows it for the slideshow
+ * duration, after which ended() is emitted. With a duration of zero, the image
+ * ends as soon as it is shown, just like a single-frame video.
+ *
+ * Upcoming images can be decoded ahead of time with prefetch(); decoding runs
+ * in parallel on a thread pool. Decoded frames are kept in a cache with a
+ * memory budget, so that switching to a prefetched image is immediate. */
+class ImageSource : public QObject
+{
+Q_OBJECT
+
+public:
+    enum State {
+        Stopped,
+        Playing,
+        Paused
+    };
+
+private:
+    QThreadPool _threadPool;
+    QVideoSink* _videoSink;
+    QUrl _source;
+    UrlLoader* _loader;
+    QVideoFrame _frame;
+    bool _frameIsReady;
+    State _state;
+    int _duration;
+    int _remaining;
+    QTimer _durationTimer;
+    QElapsedTimer _playTimer;
+    // decoded frames, least recently used first:
+    QMap<QUrl, QVideoFrame> _cache;
+    QList<QUrl> _cacheLru;
+    qint64 _cacheSize;
+    qint64 _cacheBudget;    // in bytes
+    // URLs that are currently being decoded:
+    QSet<QUrl> _pending;
+
+    void startDecoding(const QUrl& url, const QByteArray& data, UrlLoader* loader = nullptr);
+    void decodingFinished(const QUrl& url, const QVideoFrame& frame);
+    void insertIntoCache(const QUrl& url, const QVideoFrame& frame);
+    void present();
+    void setState(State state);
+    void durationElapsed();
+
+public:
+    ImageSource(QObject* parent = nullptr);
+    virtual ~ImageSource();
+
+    /* Whether the given URL is handled by this source instead of QMediaPlayer */
+    static bool handles(const QUrl& url);
+
+    /* Decode an image into a video frame. This is thread-safe. */
+    static QVideoFrame decode(const QUrl& url, const QByteArray& data);
+
+    void setVideoSink(QVideoSink* sink);
+    void setDuration(int milliseconds); // slideshow duration; 0 means end immediately
+    int duration() const;
+
+    /* Decode the given images in the background, if they are handled by this source */
+    void prefetch(const QList<QUrl>& urls);
+    /* Return the decoded frame if it is in the cache, or an invalid frame */
+    QVideoFrame cachedFrame(const QUrl& url) const;
+
+    void setSource(const QUrl& url);    // an empty URL stops and clears the source
+    QUrl source() const;
+    State state() const;
+
+    void play();
+    void pause();
+    void stop();
+
+signals:
+    void frameReady();
+    void prefetched(const QUrl& url);
+    void errorOccurred(const QString& errorString);
+    void stateChanged(ImageSource::State state);
+    void ended();
+};
@@ -4,7 +4,7 @@
  * Copyright (C) 2016, 2017 Computer Graphics Group, University of Siegen
  * Written by Martin Lambers <martin.lambers@uni-siegen.de>
  *
- * Copyright (C) 2022
+ * Copyright (C) 2022, 2026
  * Martin Lambers <marlam@marlam.de>
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
@@ -27,7 +27,15 @@
  */
 
 #include <cstdio>
+#include <cstring>
+#include <cstdint>
 #include <string>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
 
 #ifdef ANDROID
 # include <android/log.h>
@@ -37,7 +45,234 @@
 
 static LogLevel logLevel;
 static std::string logFile;
-static FILE* logStream = nullptr;
+static std::atomic<FILE*> logStream(nullptr);
+static std::atomic<unsigned long long> logLineCount(0);
+
+/* Log lines are written by a background thread so that logging threads
+ * (including the render thread) never block in a write system call.
+ *
+ * The lines are passed through a bounded lock-free multi-producer
+ * single-consumer ring buffer (Vyukov's bounded queue, with a single
+ * consumer). The writer thread collects as many complete lines as fit into
+ * one batch and writes each batch with one call to an unbuffered stream.
+ * Since batches are no larger than PIPE_BUF, the output of different
+ * processes is still not mangled, just as with the original one line per
+ * fputs() call.
+ *
+ * If more than logLinesPerSecond lines are logged per second, debug and
+ * firehose messages are dropped and counted. Informational messages are never
+ * dropped, since they include the output that the user requested with
+ * LOG_REQUESTED, e.g. --list-tracks. Otherwise no message is
+ * dropped: if the buffer is full, fatal errors and warnings are written
+ * directly, and other messages wait until the writer has made room. A fatal
+ * error additionally waits until everything logged before it is written.
+ *
+ * The writer sleeps while the buffer is empty. It announces this in
+ * _writerSleeping before it checks the buffer for the last time, and a
+ * producer checks _writerSleeping after publishing its line; with
+ * sequentially consistent ordering, at least one of them sees the other.
+ * The producer then notifies under the mutex, which the writer holds from
+ * its last check until it waits, so the notification cannot get lost. */
+
+static const size_t logSlotCount = 1024;        // must be a power of two
+static const size_t logBatchSize = 4096;        // PIPE_BUF on Linux
+static const int logLinesPerSecond = 20000;
+
+namespace {
+
+struct LogSlot {
+    std::atomic<size_t> sequence;
+    int length;
+    char line[LOG_BUFSIZE];
+};
+
+class LogWriter
+{
+private:
+    LogSlot _slots[logSlotCount];
+    std::atomic<size_t> _enqueuePos;
+    size_t _dequeuePos;                         // only used by the writer thread
+    std::atomic<size_t> _writtenPos;            // everything before this was written
+    std::atomic<unsigned long long> _dropped;
+    unsigned long long _droppedReported;        // only used by the writer thread
+    std::atomic<long long> _rateSecond;
+    std::atomic<int> _rateCount;
+    std::once_flag _startFlag;
+    std::atomic<bool> _running;
+    std::atomic<bool> _stopRequested;
+    std::atomic<bool> _writerSleeping;
+    std::mutex _mutex;
+    std::condition_variable _wakeup;
+    std::condition_variable _written;
+    std::thread _thread;
+
+    void run()
+    {
+        char batch[logBatchSize];
+        for (;;) {
+            // when stopping, drain the buffer one last time
+            bool stopping = _stopRequested.load();
+            size_t batchLength = 0;
+            unsigned long long dropped = _dropped.load(std::memory_order_relaxed);
+            if (dropped != _droppedReported) {
+                batchLength = snprintf(batch, logBatchSize, "Bino: %llu log messages were dropped\n", dropped - _droppedReported);
+                _droppedReported = dropped;
+            }
+            for (;;) {
+                LogSlot& slot = _slots[_dequeuePos & (logSlotCount - 1)];
+                size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                if (sequence != _dequeuePos + 1)
+                    break; // empty
+                if (batchLength + slot.length > logBatchSize) {
+                    writeBatch(batch, batchLength);
+                    batchLength = 0;
+                }
+                std::memcpy(batch + batchLength, slot.line, slot.length);
+                batchLength += slot.length;
+                slot.sequence.store(_dequeuePos + logSlotCount, std::memory_order_release);
+                _dequeuePos++;
+            }
+            if (batchLength > 0)
+                writeBatch(batch, batchLength);
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _writtenPos.store(_dequeuePos);
+                _written.notify_all();
+                if (stopping)
+                    break;
+                // Producers only notify a sleeping writer; see above
+                _writerSleeping.store(true);
+                _wakeup.wait(lock, [this]() {
+                        return _stopRequested.load()
+                            || _slots[_dequeuePos & (logSlotCount - 1)].sequence.load() == _dequeuePos + 1;
+                        });
+                _writerSleeping.store(false);
+            }
+        }
+    }
+
+    void writeBatch(const char* batch, size_t length)
+    {
+        FILE* stream = logStream.load();
+        std::fwrite(batch, 1, length, stream ? stream : stderr);
+    }
+
+    bool rateExceeded()
+    {
+        long long second = std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        long long rateSecond = _rateSecond.load(std::memory_order_relaxed);
+        if (second != rateSecond && _rateSecond.compare_exchange_strong(rateSecond, second))
+            _rateCount.store(0, std::memory_order_relaxed);
+        return _rateCount.fetch_add(1, std::memory_order_relaxed) >= logLinesPerSecond;
+    }
+
+    bool push(const char* line, int length)
+    {
+        size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            LogSlot& slot = _slots[pos & (logSlotCount - 1)];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            intptr_t diff = intptr_t(sequence) - intptr_t(pos);
+            if (diff == 0) {
+                if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    std::memcpy(slot.line, line, length);
+                    slot.length = length;
+                    slot.sequence.store(pos + 1);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // full
+            } else {
+                pos = _enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+public:
+    LogWriter() :
+        _enqueuePos(0),
+        _dequeuePos(0),
+        _writtenPos(0),
+        _dropped(0),
+        _droppedReported(0),
+        _rateSecond(0),
+        _rateCount(0),
+        _running(false),
+        _stopRequested(false),
+        _writerSleeping(false)
+    {
+        for (size_t i = 0; i < logSlotCount; i++)
+            _slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    ~LogWriter()
+    {
+        if (_running.load()) {
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _stopRequested.store(true);
+                _wakeup.notify_one();
+            }
+            _thread.join();
+            _running.store(false);
+        }
+    }
+
+    /* Returns false if the line must be written directly */
+    bool write(LogLevel level, const char* line, int length)
+    {
+        if (_stopRequested.load(std::memory_order_relaxed))
+            return false;
+        std::call_once(_startFlag, [this]() {
+                _thread = std::thread([this]() { run(); });
+                _running.store(true);
+                });
+        if (level >= Log_Level_Debug && rateExceeded()) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        for (;;) {
+            size_t writtenPos = _writtenPos.load();
+            if (push(line, length))
+                break;
+            if (level <= Log_Level_Warning)
+                return false;
+            // wait until the writer has made room
+            std::unique_lock<std::mutex> lock(_mutex);
+            _wakeup.notify_one();
+            _written.wait(lock, [this, writtenPos]() { return _writtenPos.load() != writtenPos || _stopRequested.load(); });
+            if (_stopRequested.load())
+                return false;
+        }
+        if (_writerSleeping.load()) {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _wakeup.notify_one();
+        }
+        if (level == Log_Level_Fatal)
+            flush();
+        return true;
+    }
+
+    void flush()
+    {
+        if (!_running.load() || _stopRequested.load())
+            return;
+        size_t pos = _enqueuePos.load();
+        std::unique_lock<std::mutex> lock(_mutex);
+        _wakeup.notify_one();
+        _written.wait(lock, [this, pos]() { return _writtenPos.load() >= pos || _stopRequested.load(); });
+    }
+
+    unsigned long long dropped() const
+    {
+        return _dropped.load(std::memory_order_relaxed);
+    }
+};
+
+}
+
+static LogWriter logWriter;
 
 void SetLogLevel(LogLevel l)
 {
@@ -57,11 +292,14 @@ void SetLogFile(const char* name, bool truncate)
     } else {
         if (truncate)
             std::remove(name);
-        if (!(logStream = std::fopen(name, "a"))) {
+        FILE* stream = std::fopen(name, "a");
+        if (!stream) {
             LOG_WARNING("cannot open log file %s", name);
         } else {
-            std::setbuf(logStream, nullptr);
+            // unbuffered, so that each batch is written with one system call
+            std::setbuf(stream, nullptr);
             logFile = name;
+            logStream = stream;
         }
     }
 }
@@ -71,8 +309,24 @@ const char* GetLogFile()
     return logFile.empty() ? nullptr : logFile.c_str();
 }
 
+void LogFlush()
+{
+    logWriter.flush();
+}
+
+unsigned long long GetLogDroppedCount()
+{
+    return logWriter.dropped();
+}
+
+unsigned long long GetLogLineCount()
+{
+    return logLineCount.load(std::memory_order_relaxed);
+}
+
 void Log(LogLevel level, const char* s)
 {
+    logLineCount.fetch_add(1, std::memory_order_relaxed);
 #ifdef ANDROID
     // On Android, if there is no log file we always use the system log facility
     // instead of stderr so that all messages are easily available in the Android monitor.
@@ -87,15 +341,18 @@ void Log(LogLevel level, const char* s)
         return;
     }
 #endif
-    (void)level;
-    // We want to print one complete line with exactly one call to fputs to
-    // line-buffered stderr so that the output of different processes is not
-    // mangled. Therefore we buffer what we want to print.
+    // We want to print one complete line with exactly one write so that the
+    // output of different processes is not mangled. Therefore we buffer what
+    // we want to print.
     char buf[LOG_BUFSIZE] = "Bino";
     int bufIndex = 4;
     bufIndex += snprintf(buf + bufIndex, LOG_BUFSIZE - bufIndex, ": %s", s);
     buf[std::min(bufIndex, LOG_BUFSIZE - 2)] = '\n';
     bufIndex++;
     buf[std::min(bufIndex, LOG_BUFSIZE - 1)] = '\0';
-    std::fputs(buf, logStream ? logStream : stderr);
+    int length = std::min(bufIndex, LOG_BUFSIZE - 1);
+    if (!logWriter.write(level, buf, length)) {
+        FILE* stream = logStream.load();
+        std::fputs(buf, stream ? stream : stderr);
+    }
 }
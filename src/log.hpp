@@ -4,7 +4,7 @@
  * Copyright (C) 2016, 2017 Computer Graphics Group, University of Siegen
  * Written by Martin Lambers <martin.lambers@uni-siegen.de>
  *
- * Copyright (C) 2022
+ * Copyright (C) 2022, 2026
  * Martin Lambers <marlam@marlam.de>
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
@@ -51,15 +51,33 @@ LogLevel GetLogLevel();
 void SetLogFile(const char* name, bool truncate); /* nullptr means stderr */
 const char* GetLogFile(); /* nullptr means stderr */
 
-/* Send one line to the log (\n will be appended) */
+/* The number of lines sent to the log so far, including dropped lines */
+unsigned long long GetLogLineCount();
+
+/* Send one line to the log (\n will be appended). The line is written
+ * asynchronously by a background thread; see log.cpp. */
 void Log(LogLevel level, const char* s);
 
+/* Wait until all lines logged so far are written */
+void LogFlush();
+
+/* The number of lines that were dropped because too many were logged */
+unsigned long long GetLogDroppedCount();
+
+/* The most verbose level that is compiled in. The macros of more verbose
+ * levels are removed by the compiler (but their arguments are still checked).
+ * See BINO_LOG_LEVEL in CMakeLists.txt. */
+#ifndef LOG_COMPILED_LEVEL
+# define LOG_COMPILED_LEVEL Log_Level_Firehose
+#endif
+
 #define LOG_BUFSIZE 1024
 
 #define LOG_MSG(level, ...) { char buf[LOG_BUFSIZE]; snprintf(buf, LOG_BUFSIZE, __VA_ARGS__); Log(level, buf); }
 #define LOG_REQUESTED(...)  { LOG_MSG(Log_Level_Info, __VA_ARGS__); }
 #define LOG_FATAL(...)      { LOG_MSG(Log_Level_Fatal, __VA_ARGS__); }
-#define LOG_WARNING(...)    { if (GetLogLevel() >= Log_Level_Warning)  { LOG_MSG(Log_Level_Warning, __VA_ARGS__); } }
-#define LOG_INFO(...)       { if (GetLogLevel() >= Log_Level_Info)     { LOG_MSG(Log_Level_Info, __VA_ARGS__); } }
-#define LOG_DEBUG(...)      { if (GetLogLevel() >= Log_Level_Debug)    { LOG_MSG(Log_Level_Debug, __VA_ARGS__); } }
-#define LOG_FIREHOSE(...)   { if (GetLogLevel() >= Log_Level_Firehose) { LOG_MSG(Log_Level_Firehose, __VA_ARGS__); } }
+#define LOG_ENABLED(level)  (LOG_COMPILED_LEVEL >= level && GetLogLevel() >= level)
+#define LOG_WARNING(...)    { if (LOG_ENABLED(Log_Level_Warning))  { LOG_MSG(Log_Level_Warning, __VA_ARGS__); } }
+#define LOG_INFO(...)       { if (LOG_ENABLED(Log_Level_Info))     { LOG_MSG(Log_Level_Info, __VA_ARGS__); } }
+#define LOG_DEBUG(...)      { if (LOG_ENABLED(Log_Level_Debug))    { LOG_MSG(Log_Level_Debug, __VA_ARGS__); } }
+#define LOG_FIREHOSE(...)   { if (LOG_ENABLED(Log_Level_Firehose)) { LOG_MSG(Log_Level_Firehose, __VA_ARGS__); } }
@@ -46,6 +46,7 @@
 
 #include "version.hpp"
 #include "log.hpp"
+#include "trace.hpp"
 #include "videosink.hpp"
 #include "playlist.hpp"
 #include "metadata.hpp"
@@ -53,6 +54,8 @@
 #include "qvrapp.hpp"
 #include "gui.hpp"
 #include "commandinterpreter.hpp"
+#include "syncfollower.hpp"
+#include "headless.hpp"
 #include "modes.hpp"
 #include "tools.hpp"
 #include "bino.hpp"
@@ -91,6 +94,14 @@ int main(int argc, char* argv[])
         }
     }
 #endif
+    // Early check before the QApplication is created: is a window system needed?
+    for (int i = 1; i < argc; i++) {
+        if (QString(argv[i]) == "--headless") {
+            if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+                qputenv("QT_QPA_PLATFORM", "offscreen");
+            break;
+        }
+    }
 
     // Initialize Qt
     qInstallMessageHandler(logQtMsg);
@@ -125,6 +136,9 @@ int main(int argc, char* argv[])
     parser.addOption({ "log-file",
             QCommandLineParser::tr("Set log file."),
             "file" });
+    parser.addOption({ "trace-file",
+            QCommandLineParser::tr("Write a trace of the frame processing stages to this file."),
+            "file" });
     parser.addOption({ "control-file",
             QCommandLineParser::tr("Get control commands from a file."), "file" });
     parser.addOption({ "control-fifo",
@@ -133,6 +147,8 @@ int main(int argc, char* argv[])
             QCommandLineParser::tr("Get control commands from a Unix Domain Socket."), "name" });
     parser.addOption({ "control-tcp",
             QCommandLineParser::tr("Get control commands by listening on a TCP port."), "[ip|name]:port" });
+    parser.addOption({ "sync-follower",
+            QCommandLineParser::tr("Synchronize playback to the Bino instance that listens on this TCP port."), "ip|name:port" });
     parser.addOption({ "stereo",
             QCommandLineParser::tr("Enable OpenGL quad-buffered stereo support.") });
     parser.addOption({ "opengles",
@@ -148,6 +164,17 @@ int main(int argc, char* argv[])
     parser.addOption({ "vr-show-devices",
             QCommandLineParser::tr("Set show-devices mode (%1).").arg("off, on"),
             "mode" });
+    parser.addOption({ "headless",
+            QCommandLineParser::tr("Render without a window and write the output frames to a file.") });
+    parser.addOption({ "headless-output",
+            QCommandLineParser::tr("Set the output file for headless mode (default: - for stdout)."),
+            "file" });
+    parser.addOption({ "headless-format",
+            QCommandLineParser::tr("Set the output format for headless mode (%1).").arg("y4m, rgb"),
+            "format" });
+    parser.addOption({ "headless-size",
+            QCommandLineParser::tr("Set the output frame size for headless mode (default 1920x1080)."),
+            "WxH" });
     parser.addOption({ "capture",
             QCommandLineParser::tr("Capture audio/video input from microphone and camera/screen/window.") });
     parser.addOption({ "list-audio-outputs",
@@ -199,6 +226,9 @@ int main(int argc, char* argv[])
     parser.addOption({ { "w", "wait" },
             QCommandLineParser::tr("Set wait mode (%1).").arg("off, on"),
             "mode" });
+    parser.addOption({ "slideshow-duration",
+            QCommandLineParser::tr("Show images for the given number of seconds, then continue with the next playlist entry."),
+            "seconds" });
     parser.addOption({ { "i", "input" },
             QCommandLineParser::tr("Set input mode (%1).").arg("mono, "
             "top-bottom, top-bottom-half, bottom-top, bottom-top-half, "
@@ -248,6 +278,13 @@ int main(int argc, char* argv[])
             LOG_FATAL("%s", qPrintable(QCommandLineParser::tr("Invalid argument for option %1").arg("--log-level")));
             return 1;
         }
+        if (GetLogLevel() > LOG_COMPILED_LEVEL) {
+            LOG_WARNING("%s", qPrintable(QCommandLineParser::tr("Log level %1 is not available in this build").arg(parser.value("log-level"))));
+        }
+    }
+    if (parser.isSet("trace-file") && !vrChildProcess) {
+        if (!TraceStart(qPrintable(parser.value("trace-file"))))
+            return 1;
     }
     LOG_DEBUG("Bino version " BINO_VERSION);
     LOG_DEBUG("Built against Qt version " QT_VERSION_STR);
@@ -261,6 +298,32 @@ int main(int argc, char* argv[])
         return 1;
     }
 #endif
+    if (parser.isSet("vr") && parser.isSet("headless")) {
+        LOG_FATAL("%s", qPrintable(QCommandLineParser::tr("Cannot use VR mode and headless mode at the same time.")));
+        return 1;
+    }
+
+    // Headless mode parameters
+    Headless::Format headlessFormat = Headless::Format_Y4M;
+    if (parser.isSet("headless-format")) {
+        if (parser.value("headless-format") == "y4m")
+            headlessFormat = Headless::Format_Y4M;
+        else if (parser.value("headless-format") == "rgb")
+            headlessFormat = Headless::Format_RGB;
+        else {
+            LOG_FATAL("%s", qPrintable(QCommandLineParser::tr("Invalid argument for option %1").arg("--headless-format")));
+            return 1;
+        }
+    }
+    int headlessWidth = 1920;
+    int headlessHeight = 1080;
+    if (parser.isSet("headless-size")) {
+        if (2 != std::sscanf(qPrintable(parser.value("headless-size")), "%dx%d", &headlessWidth, &headlessHeight)
+                || headlessWidth < 1 || headlessHeight < 1) {
+            LOG_FATAL("%s", qPrintable(QCommandLineParser::tr("Invalid argument for option %1").arg("--headless-size")));
+            return 1;
+        }
+    }
 
     // Set modes
     SurroundMode surroundMode = Surround_Unknown;
@@ -479,6 +542,16 @@ int main(int argc, char* argv[])
         }
         playlist.setWaitMode(waitMode);
     }
+    int slideshowDuration = 0;
+    if (parser.isSet("slideshow-duration")) {
+        bool ok;
+        double seconds = parser.value("slideshow-duration").toDouble(&ok);
+        if (!ok || seconds < 0.0 || seconds > 86400.0) {
+            LOG_FATAL("%s", qPrintable(QCommandLineParser::tr("Invalid argument for option %1").arg("--slideshow-duration")));
+            return 1;
+        }
+        slideshowDuration = seconds * 1000.0;
+    }
     int videoTrack = PlaylistEntry::DefaultTrack;
     int audioTrack = PlaylistEntry::DefaultTrack;
     int subtitleTrack = PlaylistEntry::DefaultTrack;
@@ -543,7 +616,11 @@ int main(int argc, char* argv[])
         }
     }
     if (!parser.isSet("wait")) {
-        playlist.setWaitModeAuto();
+        // a slideshow must not wait for the user after each image
+        if (parser.isSet("slideshow-duration"))
+            playlist.setWaitMode(Wait_Off);
+        else
+            playlist.setWaitModeAuto();
     }
     if (parser.isSet("capture") && playlist.length() > 0) {
         LOG_FATAL("%s", qPrintable(QCommandLineParser::tr("Cannot capture and play URL at the same time.")));
@@ -654,6 +731,9 @@ int main(int argc, char* argv[])
         }
     }
 
+    // Detect meta data of upcoming playlist entries in the background
+    MetaDataPrefetcher metaDataPrefetcher;
+
     // Initialize the command interpreter (but don't start it yet)
     CommandInterpreter cmdInterpreter;
     if (parser.isSet("control-file")) {
@@ -674,10 +754,19 @@ int main(int argc, char* argv[])
         }
     }
 
+    // Initialize synchronization to a master instance (but don't start it yet)
+    SyncFollower syncFollower;
+    if (parser.isSet("sync-follower") && !vrChildProcess) {
+        if (!syncFollower.init(parser.value("sync-follower"))) {
+            return 1;
+        }
+    }
+
     // Determine VR or GUI mode
     bool vrMainProcess = parser.isSet("vr");
     bool vrMode = (vrMainProcess || vrChildProcess);
-    bool guiMode = !vrMode;
+    bool headlessMode = (!vrMode && parser.isSet("headless"));
+    bool guiMode = !vrMode && !headlessMode;
 
     // Set the OpenGL context parameters
     QSurfaceFormat format;
@@ -719,6 +808,7 @@ int main(int argc, char* argv[])
         bino.initializeOutput(audioOutputDeviceIndex >= 0
                 ? audioOutputDevices[audioOutputDeviceIndex]
                 : QMediaDevices::defaultAudioOutput());
+        bino.setSlideshowDuration(slideshowDuration);
         if (parser.isSet("capture")) {
             if (screenInputDeviceIndex < 0 && windowInputDeviceIndex < 0) {
                 bino.startCaptureModeCamera(audioInputDeviceIndex >= -1,
@@ -759,11 +849,32 @@ int main(int argc, char* argv[])
         }
         playlist.start();
         cmdInterpreter.start();
+        syncFollower.start();
         return app.exec();
 #else
         (void)vrShowDevices;
         return 1;
 #endif
+    } else if (headlessMode) {
+        if (playlist.length() == 0 && !parser.isSet("capture") && !cmdInterpreter.isInitialized()) {
+            LOG_FATAL("%s", qPrintable(QCommandLineParser::tr("Nothing to render in headless mode.")));
+            return 1;
+        }
+        Headless headless(outputMode, headlessWidth, headlessHeight, headlessFormat);
+        if (!headless.init(parser.isSet("headless-output") ? parser.value("headless-output") : QString("-")))
+            return 1;
+        // There is no user who could continue a waiting playlist
+        if (!parser.isSet("wait"))
+            playlist.setWaitMode(Wait_Off);
+        QObject::connect(&bino, &Bino::wantQuit, [&]() { headless.finish(); app.quit(); });
+        if (!cmdInterpreter.isInitialized()) {
+            // quit when the playlist is done, unless a script controls us
+            QObject::connect(&playlist, &Playlist::finished, [&]() { headless.finish(); app.quit(); });
+        }
+        playlist.start();
+        cmdInterpreter.start();
+        syncFollower.start();
+        return app.exec();
     } else {
         // Restore GUI settings unless they were overwritten on the command line
         if (!parser.isSet("output")) {
@@ -781,6 +892,7 @@ int main(int argc, char* argv[])
         QGuiApplication::processEvents(QEventLoop::AllEvents, 3000);
         playlist.start();
         cmdInterpreter.start();
+        syncFollower.start();
         return app.exec();
     }
 }
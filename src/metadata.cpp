@@ -1,7 +1,7 @@
 /*
  * This file is part of Bino, a 3D video player.
  *
- * Copyright (C) 2022, 2023, 2024, 2025
+ * Copyright (C) 2022, 2023, 2024, 2025, 2026
  * Martin Lambers <marlam@marlam.de>
  *
  * This program is free software; you can redistribute it and/or modify
@@ -24,11 +24,23 @@
 #include <QMap>
 #include <QJsonDocument>
 #include <QJsonValue>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QSaveFile>
+#include <QLockFile>
+#include <QStandardPaths>
+#include <QDataStream>
+#include <QMutex>
+#include <QEventLoop>
+#include <QTimer>
 #ifndef Q_OS_WASM
 # include <QProcess>
 #endif
 
 #include "metadata.hpp"
+#include "containerprobe.hpp"
+#include "imagesource.hpp"
 #include "tools.hpp"
 #include "log.hpp"
 
@@ -38,24 +50,315 @@ MetaData::MetaData()
 }
 
 static int haveFFprobe = -1;
+static QMutex ffprobeMutex; // ffprobe may run in prefetcher threads
 static QMap<QUrl, MetaData> cache;
 
-bool MetaData::detectCached(const QUrl& url, QString* errMsg)
+/* The persistent cache. It is stored in a file that consists of a header
+ * followed by records; new records are appended. A later record for the same
+ * URL replaces an earlier one. When the file grows beyond its size cap, it is
+ * compacted: stale entries and the oldest entries are removed.
+ * Only local files are cached persistently since only for those we can detect
+ * changes via file size and modification time. */
+
+static const quint32 persistentCacheMagic = 0x42696e4d; // "BinM"
+static const quint32 persistentCacheVersion = 1;
+static const qint64 persistentCacheMaxSize = 16 * 1024 * 1024;
+
+class PersistentCacheEntry
 {
-    /* Try to find the url in the cache */
-    *this = cache[url];
-    if (!this->url.isEmpty())
+public:
+    qint64 size;
+    qint64 lastModified;
+    MetaData metaData;
+};
+
+static bool persistentCacheLoaded = false;
+static QMap<QUrl, PersistentCacheEntry> persistentCache;
+
+static QString persistentCacheFileName()
+{
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (dir.isEmpty() || !QDir().mkpath(dir))
+        return QString();
+    return dir + "/metadata-cache";
+}
+
+static bool persistentCacheKey(const QUrl& url, qint64& size, qint64& lastModified)
+{
+    if (!url.isLocalFile())
+        return false;
+    QFileInfo fileInfo(url.toLocalFile());
+    if (!fileInfo.isFile())
+        return false;
+    size = fileInfo.size();
+    lastModified = fileInfo.lastModified().toMSecsSinceEpoch();
+    return true;
+}
+
+static void writeMediaMetaData(QDataStream& ds, const QMediaMetaData& md)
+{
+    // Enum values cannot be streamed via QVariant, so we store them as integers
+    // together with their type name. Images are not stored to keep the cache compact.
+    QList<QMediaMetaData::Key> keys;
+    for (QMediaMetaData::Key key : md.keys()) {
+        QMetaType type = md.value(key).metaType();
+        if (key == QMediaMetaData::ThumbnailImage || key == QMediaMetaData::CoverArtImage)
+            continue;
+        if ((type.flags() & QMetaType::IsEnumeration) || type.hasRegisteredDataStreamOperators())
+            keys.append(key);
+    }
+    ds << qint32(keys.size());
+    for (QMediaMetaData::Key key : keys) {
+        QVariant value = md.value(key);
+        ds << qint32(key);
+        if (value.metaType().flags() & QMetaType::IsEnumeration) {
+            ds << QByteArray(value.metaType().name()) << value.toLongLong();
+        } else {
+            ds << QByteArray() << value;
+        }
+    }
+}
+
+static void readMediaMetaData(QDataStream& ds, QMediaMetaData& md)
+{
+    md.clear();
+    qint32 n;
+    ds >> n;
+    for (qint32 i = 0; i < n && ds.status() == QDataStream::Ok; i++) {
+        qint32 key;
+        QByteArray typeName;
+        QVariant value;
+        ds >> key >> typeName;
+        if (typeName.isEmpty()) {
+            ds >> value;
+        } else {
+            qlonglong v;
+            ds >> v;
+            value = QVariant::fromValue(v);
+            QMetaType type = QMetaType::fromName(typeName);
+            if (!type.isValid() || !value.convert(type))
+                continue;
+        }
+        md.insert(static_cast<QMediaMetaData::Key>(key), value);
+    }
+}
+
+static void writeModes(QDataStream& ds, const QList<InputMode>& inputModes, const QList<SurroundMode>& surroundModes)
+{
+    ds << qint32(inputModes.size());
+    for (InputMode m : inputModes)
+        ds << qint32(m);
+    ds << qint32(surroundModes.size());
+    for (SurroundMode m : surroundModes)
+        ds << qint32(m);
+}
+
+static void readModes(QDataStream& ds, QList<InputMode>& inputModes, QList<SurroundMode>& surroundModes)
+{
+    qint32 n, m;
+    ds >> n;
+    inputModes.clear();
+    for (qint32 i = 0; i < n && ds.status() == QDataStream::Ok; i++) {
+        ds >> m;
+        inputModes.append(static_cast<InputMode>(m));
+    }
+    ds >> n;
+    surroundModes.clear();
+    for (qint32 i = 0; i < n && ds.status() == QDataStream::Ok; i++) {
+        ds >> m;
+        surroundModes.append(static_cast<SurroundMode>(m));
+    }
+}
+
+static QByteArray serializePersistentCacheEntry(const PersistentCacheEntry& entry)
+{
+    QByteArray record;
+    QDataStream ds(&record, QIODeviceBase::WriteOnly);
+    ds.setVersion(QDataStream::Qt_6_7);
+    ds << entry.metaData.url << entry.size << entry.lastModified;
+    writeMediaMetaData(ds, entry.metaData.global);
+    for (const QList<QMediaMetaData>* list : { &entry.metaData.videoTracks, &entry.metaData.audioTracks, &entry.metaData.subtitleTracks }) {
+        ds << qint32(list->size());
+        for (const QMediaMetaData& md : *list)
+            writeMediaMetaData(ds, md);
+    }
+    writeModes(ds, entry.metaData.inputModes, entry.metaData.surroundModes);
+    return record;
+}
+
+static bool deserializePersistentCacheEntry(const QByteArray& record, PersistentCacheEntry& entry)
+{
+    QDataStream ds(record);
+    ds.setVersion(QDataStream::Qt_6_7);
+    ds >> entry.metaData.url >> entry.size >> entry.lastModified;
+    readMediaMetaData(ds, entry.metaData.global);
+    for (QList<QMediaMetaData>* list : { &entry.metaData.videoTracks, &entry.metaData.audioTracks, &entry.metaData.subtitleTracks }) {
+        qint32 n;
+        ds >> n;
+        list->clear();
+        for (qint32 i = 0; i < n && ds.status() == QDataStream::Ok; i++) {
+            list->append(QMediaMetaData());
+            readMediaMetaData(ds, list->last());
+        }
+    }
+    readModes(ds, entry.metaData.inputModes, entry.metaData.surroundModes);
+    return (ds.status() == QDataStream::Ok && !entry.metaData.url.isEmpty());
+}
+
+static void compactPersistentCache(const QString& fileName, const QList<QByteArray>& records)
+{
+    // Keep only the newest valid record for each URL, newest first, up to half the size cap
+    QList<QByteArray> keep;
+    QMap<QUrl, bool> seen;
+    qint64 keepSize = 0;
+    for (qsizetype i = records.size() - 1; i >= 0; i--) {
+        PersistentCacheEntry entry;
+        qint64 size, lastModified;
+        if (!deserializePersistentCacheEntry(records[i], entry)
+                || seen.contains(entry.metaData.url)
+                || !persistentCacheKey(entry.metaData.url, size, lastModified)
+                || size != entry.size || lastModified != entry.lastModified) {
+            persistentCache.remove(entry.metaData.url);
+            continue;
+        }
+        seen.insert(entry.metaData.url, true);
+        if (keepSize + records[i].size() > persistentCacheMaxSize / 2) {
+            persistentCache.remove(entry.metaData.url);
+            continue;
+        }
+        keepSize += records[i].size();
+        keep.prepend(records[i]);
+    }
+    QSaveFile file(fileName);
+    if (file.open(QIODeviceBase::WriteOnly)) {
+        QDataStream ds(&file);
+        ds << persistentCacheMagic << persistentCacheVersion;
+        for (const QByteArray& record : keep)
+            ds << record;
+        file.commit();
+    }
+    LOG_DEBUG("compacted meta data cache from %d to %d records", int(records.size()), int(keep.size()));
+}
+
+static bool readPersistentCacheRecords(QFile& file, QList<QByteArray>& records)
+{
+    QDataStream ds(&file);
+    quint32 magic, version;
+    ds >> magic >> version;
+    if (ds.status() != QDataStream::Ok || magic != persistentCacheMagic || version != persistentCacheVersion)
+        return false;
+    while (!ds.atEnd()) {
+        QByteArray record;
+        ds >> record;
+        if (ds.status() != QDataStream::Ok)
+            break; // truncated, e.g. after a crash; ignore the rest
+        records.append(record);
+    }
+    return true;
+}
+
+static void loadPersistentCache()
+{
+    if (persistentCacheLoaded)
+        return;
+    persistentCacheLoaded = true;
+    QString fileName = persistentCacheFileName();
+    if (fileName.isEmpty())
+        return;
+    QLockFile lock(fileName + ".lock");
+    if (!lock.tryLock(1000))
+        return;
+    QFile file(fileName);
+    if (!file.open(QIODeviceBase::ReadOnly))
+        return;
+    QList<QByteArray> records;
+    bool valid = readPersistentCacheRecords(file, records);
+    for (const QByteArray& record : records) {
+        PersistentCacheEntry entry;
+        if (deserializePersistentCacheEntry(record, entry))
+            persistentCache.insert(entry.metaData.url, entry);
+    }
+    LOG_DEBUG("loaded %d entries from meta data cache %s", int(persistentCache.size()), qPrintable(fileName));
+    bool needsCompaction = (file.size() > persistentCacheMaxSize || !valid);
+    file.close();
+    if (needsCompaction)
+        compactPersistentCache(fileName, records);
+}
+
+static void appendToPersistentCache(const PersistentCacheEntry& entry)
+{
+    QString fileName = persistentCacheFileName();
+    if (fileName.isEmpty())
+        return;
+    QByteArray record = serializePersistentCacheEntry(entry);
+    QLockFile lock(fileName + ".lock");
+    if (!lock.tryLock(1000))
+        return;
+    QFile file(fileName);
+    if (!file.open(QIODeviceBase::WriteOnly | QIODeviceBase::Append))
+        return;
+    // Write the record with a single call so that a crash cannot leave a partial record
+    // in the middle of the file.
+    QByteArray data;
+    QDataStream ds(&data, QIODeviceBase::WriteOnly);
+    if (file.size() == 0)
+        ds << persistentCacheMagic << persistentCacheVersion;
+    ds << record;
+    file.write(data);
+    persistentCache.insert(entry.metaData.url, entry);
+    // The cap is also enforced here since a long session can append many records
+    if (file.size() > persistentCacheMaxSize) {
+        file.close();
+        QList<QByteArray> records;
+        if (file.open(QIODeviceBase::ReadOnly))
+            readPersistentCacheRecords(file, records);
+        file.close();
+        compactPersistentCache(fileName, records);
+    }
+}
+
+/* Lookup in the in-memory cache and then in the persistent cache */
+static bool lookupCached(const QUrl& url, MetaData& metaData)
+{
+    metaData = cache[url];
+    if (!metaData.url.isEmpty())
         return true;
 
-    /* Detection via file name hints - this sets default modes that can be overridden per stream */
-    InputMode defaultInputMode = Input_Unknown;
-    SurroundMode defaultSurroundMode = Surround_Unknown;
+    qint64 fileSize, fileLastModified;
+    if (persistentCacheKey(url, fileSize, fileLastModified)) {
+        loadPersistentCache();
+        auto it = persistentCache.constFind(url);
+        if (it != persistentCache.constEnd()
+                && it->size == fileSize && it->lastModified == fileLastModified) {
+            LOG_DEBUG("meta data for %s found in persistent cache", qPrintable(url.toString()));
+            metaData = it->metaData;
+            cache.insert(url, metaData);
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Insert into the in-memory cache and, for local files, into the persistent cache */
+static void insertCached(const MetaData& metaData)
+{
+    cache.insert(metaData.url, metaData);
+    PersistentCacheEntry entry;
+    if (persistentCacheKey(metaData.url, entry.size, entry.lastModified)) {
+        entry.metaData = metaData;
+        appendToPersistentCache(entry);
+    }
+}
+
+/* Detection via file name hints - this sets default modes that can be overridden per stream */
+static void detectViaFileName(const QUrl& url, InputMode& defaultInputMode, SurroundMode& defaultSurroundMode)
+{
     QString fileName = url.fileName();
     QString extension = getExtension(fileName);
     if (extension == "jps" || extension == "pns") {
         defaultInputMode = Input_Right_Left;
     } else if (extension == "mpo") {
-        defaultInputMode = Input_Top_Bottom;       // this was converted; see digestiblemedia
+        defaultInputMode = Input_Top_Bottom;       // both images are stacked; see decodeStillImage()
     } else {
         /* Try to guess the input mode from a marker contained in the file name.
          * This should be compatible to the Bino 1.x naming conventions. */
@@ -95,30 +398,87 @@ bool MetaData::detectCached(const QUrl& url, QString* errMsg)
     if (defaultSurroundMode != Surround_Unknown) {
         LOG_DEBUG("guessing surround mode %s from file name %s", surroundModeToString(defaultSurroundMode), qPrintable(fileName));
     }
+}
+
+/* Still images are shown by ImageSource without a media player, so they do
+ * not need one for meta data detection either: they have a single video track,
+ * and their modes can only be guessed from the file name. */
+static void detectStillImage(const QUrl& url, MetaData& metaData)
+{
+    InputMode defaultInputMode = Input_Unknown;
+    SurroundMode defaultSurroundMode = Surround_Unknown;
+    detectViaFileName(url, defaultInputMode, defaultSurroundMode);
+    metaData.url = url;
+    metaData.videoTracks = { QMediaMetaData() };
+    metaData.inputModes = { defaultInputMode };
+    metaData.surroundModes = { defaultSurroundMode };
+}
+
+bool MetaData::detectFromCache(const QUrl& url)
+{
+    return lookupCached(url, *this);
+}
+
+bool MetaData::detectCached(const QUrl& url, QString* errMsg)
+{
+    /* Try to find the url in the cache */
+    if (lookupCached(url, *this))
+        return true;
+
+    /* If the prefetcher is already working on this url, wait for it */
+    MetaDataPrefetcher* prefetcher = MetaDataPrefetcher::instance();
+    if (prefetcher && prefetcher->isPending(url)) {
+        LOG_DEBUG("waiting for prefetched meta data for %s", qPrintable(url.toString()));
+        QEventLoop loop;
+        QObject::connect(prefetcher, &MetaDataPrefetcher::finished, &loop,
+                [&](const QUrl& finishedUrl) { if (finishedUrl == url) loop.quit(); });
+        prefetcher->request(url);
+        if (prefetcher->isPending(url))
+            loop.exec();
+        if (lookupCached(url, *this))
+            return true;
+    }
+
+    if (ImageSource::handles(url)) {
+        detectStillImage(url, *this);
+        cache.insert(url, *this);
+        return true;
+    }
+
+    InputMode defaultInputMode = Input_Unknown;
+    SurroundMode defaultSurroundMode = Surround_Unknown;
+    detectViaFileName(url, defaultInputMode, defaultSurroundMode);
 
     /* Detection via QMediaPlayer */
     QMediaPlayer player;
+    QEventLoop loop;
+    QTimer timeout;
     bool failure = false;
     bool available = false;
-    bool didFFprobe = false;
     QString errorMessage;
     player.connect(&player, &QMediaPlayer::errorOccurred,
             [&](QMediaPlayer::Error, const QString& errorString) {
             errorMessage = errorString;
             LOG_WARNING("%s", qPrintable(tr("Cannot get meta data from %1: %2").arg(player.source().toString()).arg(errorString)));
             failure = true;
+            loop.quit();
+            });
+    player.connect(&player, &QMediaPlayer::metaDataChanged, [&]() { available = true; loop.quit(); });
+    timeout.setSingleShot(true);
+    timeout.connect(&timeout, &QTimer::timeout, [&]() {
+            errorMessage = tr("Timeout");
+            LOG_WARNING("%s", qPrintable(tr("Cannot get meta data from %1: %2").arg(url.toString()).arg(errorMessage)));
+            failure = true;
+            loop.quit();
             });
-    player.connect(&player, &QMediaPlayer::metaDataChanged, [&]() { available = true; });
     player.setSource(url);
-    do {
-        // while waiting for the QMediaPlayer meta data to arrive, run ffprobe in parallel
-        if (!didFFprobe) {
-            detectViaFFprobe(url, defaultInputMode, defaultSurroundMode);
-            didFFprobe = true;
-        }
-        QGuiApplication::processEvents();
+    // while waiting for the QMediaPlayer meta data to arrive, examine the container
+    detectViaContainer(url, defaultInputMode, defaultSurroundMode);
+    if (!failure && !available) {
+        // wait without busy looping
+        timeout.start(30000);
+        loop.exec();
     }
-    while (!failure && !available);
     if (failure) {
         if (errMsg)
             *errMsg = errorMessage;
@@ -133,14 +493,24 @@ bool MetaData::detectCached(const QUrl& url, QString* errMsg)
     inputModes.resize(videoTracks.size(), defaultInputMode);
     surroundModes.resize(videoTracks.size(), defaultSurroundMode);
 
-    cache.insert(url, *this);
+    insertCached(*this);
     return true;
 }
 
+void MetaData::detectViaContainer(const QUrl& url, InputMode& defaultInputMode, SurroundMode& defaultSurroundMode)
+{
+    /* Detection via our own container parser; ffprobe is the fallback for
+     * remote URLs and container formats that we do not know */
+    if (url.isLocalFile() && probeContainer(url.toLocalFile(), defaultInputMode, defaultSurroundMode, inputModes, surroundModes))
+        return;
+    detectViaFFprobe(url, defaultInputMode, defaultSurroundMode);
+}
+
 void MetaData::detectViaFFprobe(const QUrl& url, InputMode& defaultInputMode, SurroundMode& defaultSurroundMode)
 {
 #ifndef Q_OS_WASM
     /* Detection via ffprobe (if available) */
+    ffprobeMutex.lock();
     if (haveFFprobe == -1) {
         // check once whether we can run ffprobe
         QProcess prc;
@@ -150,6 +520,7 @@ void MetaData::detectViaFFprobe(const QUrl& url, InputMode& defaultInputMode, Su
         LOG_DEBUG("ffprobe available: %d (exit status %d, exit code %d)", haveFFprobe,
                 prc.exitStatus() == QProcess::NormalExit ? 0 : 1, prc.exitCode());
     }
+    ffprobeMutex.unlock();
     if (haveFFprobe) {
         QProcess prc;
         prc.setProgram("ffprobe");
@@ -233,3 +604,194 @@ void MetaData::detectViaFFprobe(const QUrl& url, InputMode& defaultInputMode, Su
     }
 #endif
 }
+
+
+class MetaDataPrefetcher::Job
+{
+public:
+    unsigned long long id = 0; // distinguishes jobs for the same URL
+    QMediaPlayer* player = nullptr;
+    bool playerDone = false;
+    bool playerFailure = false;
+    bool modesDone = false;
+    MetaData modes;
+    InputMode defaultInputMode = Input_Unknown;
+    SurroundMode defaultSurroundMode = Surround_Unknown;
+};
+
+static MetaDataPrefetcher* prefetcherSingleton = nullptr;
+
+MetaDataPrefetcher::MetaDataPrefetcher(int lookahead, int concurrency) :
+    _lookahead(lookahead),
+    _concurrency(concurrency),
+    _lastJobId(0)
+{
+    Q_ASSERT(!prefetcherSingleton);
+    prefetcherSingleton = this;
+    _threadPool.setMaxThreadCount(_concurrency);
+    if (Playlist::instance())
+        connect(Playlist::instance(), SIGNAL(mediaChanged(PlaylistEntry)), this, SLOT(mediaChanged(PlaylistEntry)));
+}
+
+MetaDataPrefetcher::~MetaDataPrefetcher()
+{
+    _threadPool.waitForDone();
+    for (Job* job : std::as_const(_jobs)) {
+        delete job->player;
+        delete job;
+    }
+    prefetcherSingleton = nullptr;
+}
+
+MetaDataPrefetcher* MetaDataPrefetcher::instance()
+{
+    return prefetcherSingleton;
+}
+
+bool MetaDataPrefetcher::isPending(const QUrl& url) const
+{
+    return _jobs.contains(url) || _queue.contains(url);
+}
+
+void MetaDataPrefetcher::prefetch(const QList<QUrl>& urls)
+{
+    // Entries that are no longer upcoming are dropped from the queue; running jobs are finished.
+    _queue.clear();
+    for (const QUrl& url : urls) {
+        MetaData metaData;
+        if (url.isEmpty() || _jobs.contains(url) || _queue.contains(url) || lookupCached(url, metaData))
+            continue;
+        _queue.append(url);
+    }
+    startJobs();
+}
+
+void MetaDataPrefetcher::request(const QUrl& url)
+{
+    // Requested entries are needed now, so they do not wait for a free slot
+    MetaData metaData;
+    if (url.isEmpty() || _jobs.contains(url) || lookupCached(url, metaData))
+        return;
+    _queue.removeOne(url);
+    startJob(url);
+}
+
+void MetaDataPrefetcher::mediaChanged(PlaylistEntry)
+{
+    const Playlist* playlist = Playlist::instance();
+    QList<QUrl> urls;
+    for (int n = 1; n <= _lookahead; n++) {
+        int index = playlist->upcomingIndex(n);
+        if (index < 0)
+            break;
+        urls.append(playlist->entries()[index].url);
+    }
+    prefetch(urls);
+}
+
+void MetaDataPrefetcher::startJobs()
+{
+    while (_jobs.size() < _concurrency && !_queue.isEmpty())
+        startJob(_queue.takeFirst());
+}
+
+void MetaDataPrefetcher::startJob(const QUrl& url)
+{
+    LOG_DEBUG("prefetching meta data for %s", qPrintable(url.toString()));
+    Job* job = new Job;
+    job->id = ++_lastJobId;
+    unsigned long long id = job->id;
+    _jobs.insert(url, job);
+
+    if (ImageSource::handles(url)) {
+        // nothing to probe; finish asynchronously like all other jobs
+        QMetaObject::invokeMethod(this, [this, url]() {
+                MetaData metaData;
+                detectStillImage(url, metaData);
+                cache.insert(url, metaData);
+                delete _jobs.take(url);
+                emit finished(url);
+                startJobs();
+                }, Qt::QueuedConnection);
+        return;
+    }
+
+    // file name hints and container probing in a worker thread
+    _threadPool.start([this, url, id]() {
+            MetaData modes;
+            InputMode defaultInputMode = Input_Unknown;
+            SurroundMode defaultSurroundMode = Surround_Unknown;
+            detectViaFileName(url, defaultInputMode, defaultSurroundMode);
+            modes.detectViaContainer(url, defaultInputMode, defaultSurroundMode);
+            QMetaObject::invokeMethod(this, [this, url, id, modes, defaultInputMode, defaultSurroundMode]() {
+                    Job* job = _jobs.value(url);
+                    if (job && job->id == id) {
+                        job->modes = modes;
+                        job->defaultInputMode = defaultInputMode;
+                        job->defaultSurroundMode = defaultSurroundMode;
+                        job->modesDone = true;
+                        finishJobIfDone(url);
+                    }
+                }, Qt::QueuedConnection);
+            });
+
+    // QMediaPlayer in this thread, asynchronously
+    job->player = new QMediaPlayer(this);
+    connect(job->player, &QMediaPlayer::errorOccurred, this,
+            [this, url](QMediaPlayer::Error, const QString& errorString) {
+            LOG_DEBUG("cannot prefetch meta data for %s: %s", qPrintable(url.toString()), qPrintable(errorString));
+            Job* job = _jobs.value(url);
+            if (job && !job->playerDone) {
+                job->playerDone = true;
+                job->playerFailure = true;
+                finishJobIfDone(url);
+            }
+            });
+    connect(job->player, &QMediaPlayer::metaDataChanged, this,
+            [this, url]() {
+            Job* job = _jobs.value(url);
+            if (job && !job->playerDone) {
+                job->playerDone = true;
+                finishJobIfDone(url);
+            }
+            });
+    job->player->setSource(url);
+    // the timer may outlive the job, and a later job for the same URL must not be affected
+    QTimer::singleShot(30000, this, [this, url, id]() {
+            Job* job = _jobs.value(url);
+            if (job && job->id == id && !job->playerDone) {
+                LOG_DEBUG("timeout while prefetching meta data for %s", qPrintable(url.toString()));
+                job->playerDone = true;
+                job->playerFailure = true;
+                finishJobIfDone(url);
+            }
+            });
+}
+
+void MetaDataPrefetcher::finishJobIfDone(const QUrl& url)
+{
+    Job* job = _jobs.value(url);
+    if (!job->playerDone || !job->modesDone)
+        return;
+    if (!job->playerFailure) {
+        MetaData metaData;
+        metaData.url = url;
+        metaData.global = job->player->metaData();
+        metaData.videoTracks = job->player->videoTracks();
+        metaData.audioTracks = job->player->audioTracks();
+        metaData.subtitleTracks = job->player->subtitleTracks();
+        metaData.inputModes = job->modes.inputModes;
+        metaData.surroundModes = job->modes.surroundModes;
+        metaData.inputModes.resize(metaData.videoTracks.size(), job->defaultInputMode);
+        metaData.surroundModes.resize(metaData.videoTracks.size(), job->defaultSurroundMode);
+        insertCached(metaData);
+        LOG_DEBUG("prefetched meta data for %s", qPrintable(url.toString()));
+    }
+    // we may be called from a signal of the player, so do not delete it directly
+    job->player->disconnect(this);
+    job->player->deleteLater();
+    _jobs.remove(url);
+    delete job;
+    emit finished(url);
+    startJobs();
+}
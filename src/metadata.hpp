@@ -1,7 +1,7 @@
 /*
  * This file is part of Bino, a 3D video player.
  *
- * Copyright (C) 2022, 2023, 2024, 2025
+ * Copyright (C) 2022, 2023, 2024, 2025, 2026
  * Martin Lambers <marlam@marlam.de>
  *
  * This program is free software; you can redistribute it and/or modify
@@ -23,16 +23,21 @@
 #include <QGuiApplication>
 #include <QUrl>
 #include <QList>
+#include <QMap>
 #include <QMediaMetaData>
+#include <QThreadPool>
 
 #include "modes.hpp"
+#include "playlist.hpp"
 
 
 class MetaData
 {
 Q_DECLARE_TR_FUNCTIONS(MetaData)
+friend class MetaDataPrefetcher;
 
 private:
+    void detectViaContainer(const QUrl& url, InputMode& defaultInputMode, SurroundMode& defaultSurroundMode);
     void detectViaFFprobe(const QUrl& url, InputMode& defaultInputMode, SurroundMode& defaultSurroundMode);
 
 public:
@@ -46,5 +51,46 @@ public:
     QList<SurroundMode> surroundModes;
 
     MetaData();
+    bool detectFromCache(const QUrl& url); // does not detect anything if not cached
+    // Blocks in a nested event loop until the meta data is known. Only for
+    // the GUI and the command line; Bino itself waits for MetaDataPrefetcher.
     bool detectCached(const QUrl& url, QString* errMsg = nullptr);
 };
+
+
+/* Detect the meta data of the upcoming playlist entries in the background
+ * while the current entry plays, so that switching to the next entry finds
+ * its meta data in the cache. Container probing runs in a thread pool; the
+ * QMediaPlayer instances run in the main thread without blocking it. */
+class MetaDataPrefetcher : public QObject
+{
+Q_OBJECT
+
+private:
+    class Job;
+    int _lookahead;
+    int _concurrency;
+    QThreadPool _threadPool;
+    QList<QUrl> _queue;
+    QMap<QUrl, Job*> _jobs;
+    unsigned long long _lastJobId;
+
+    void startJobs();
+    void startJob(const QUrl& url);
+    void finishJobIfDone(const QUrl& url);
+
+public:
+    MetaDataPrefetcher(int lookahead = 3, int concurrency = 2);
+    virtual ~MetaDataPrefetcher();
+    static MetaDataPrefetcher* instance();
+
+    bool isPending(const QUrl& url) const;
+
+public slots:
+    void prefetch(const QList<QUrl>& urls);
+    void request(const QUrl& url); // start now, without waiting for a free slot
+    void mediaChanged(PlaylistEntry entry);
+
+signals:
+    void finished(const QUrl& url); // the meta data is now cached, or detection failed
+};
@@ -0,0 +1,217 @@
+/*
+ * This file is part of Bino, a 3D video player.
+ *
+ * Copyright (C) 2026
+ * Martin Lambers <marlam@marlam.de>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include <QList>
+#include <QBuffer>
+#include <QImageReader>
+#include <QThread>
+#include <QtEndian>
+
+#include "mpo.hpp"
+#include "log.hpp"
+
+
+/* An MPO file is a sequence of JPEG images. The first one contains an APP2
+ * segment with the identifier "MPF\0", followed by an MP header with the same
+ * layout as a TIFF header: byte order, magic number 42, and the offset of the
+ * MP Index IFD. That IFD contains the number of images (tag 0xb001) and the
+ * MP Entry (tag 0xb002), which holds 16 bytes per image: attributes, size,
+ * and offset. All offsets are relative to the start of the MP header, and the
+ * offset of the first image is zero. */
+
+namespace {
+
+quint16 get16(const uchar* p, bool bigEndian)
+{
+    return bigEndian ? qFromBigEndian<quint16>(p) : qFromLittleEndian<quint16>(p);
+}
+
+quint32 get32(const uchar* p, bool bigEndian)
+{
+    return bigEndian ? qFromBigEndian<quint32>(p) : qFromLittleEndian<quint32>(p);
+}
+
+/* Return the position of the MP header in the first image, or -1 */
+qsizetype findMpHeader(const uchar* data, qsizetype size)
+{
+    if (size < 4 || data[0] != 0xff || data[1] != 0xd8)
+        return -1;
+    qsizetype pos = 2;
+    while (pos + 4 <= size) {
+        if (data[pos] != 0xff)
+            return -1;
+        uchar marker = data[pos + 1];
+        if (marker == 0xff) { // fill byte
+            pos++;
+            continue;
+        }
+        if (marker == 0xda || marker == 0xd9) // start of scan or end of image: no more APPn segments
+            return -1;
+        qsizetype length = qFromBigEndian<quint16>(data + pos + 2);
+        if (length < 2 || pos + 2 + length > size)
+            return -1;
+        if (marker == 0xe2 && length >= 2 + 4 + 8 && std::memcmp(data + pos + 4, "MPF", 4) == 0)
+            return pos + 8;
+        pos += 2 + length;
+    }
+    return -1;
+}
+
+/* Decode a JPEG into the given image. If the image already has the size and
+ * format that the decoder produces, the decoder writes into its data. */
+bool decodeView(QByteArrayView jpeg, QImage& image)
+{
+    QByteArray bytes = QByteArray::fromRawData(jpeg.data(), jpeg.size());
+    QBuffer buffer(&bytes);
+    buffer.open(QIODeviceBase::ReadOnly);
+    QImageReader reader(&buffer, "JPG");
+    return reader.read(&image);
+}
+
+QSize viewSize(QByteArrayView jpeg)
+{
+    QByteArray bytes = QByteArray::fromRawData(jpeg.data(), jpeg.size());
+    QBuffer buffer(&bytes);
+    buffer.open(QIODeviceBase::ReadOnly);
+    QImageReader reader(&buffer, "JPG");
+    return reader.size();
+}
+
+/* Make sure that the view ended up in the given lines of the result: the
+ * decoder allocates a new image e.g. for grayscale JPEGs */
+bool placeView(QImage& view, QImage& result, int firstLine)
+{
+    if (view.constBits() == result.constScanLine(firstLine))
+        return true;
+    LOG_FIREHOSE("decodeMpo: view was not decoded in place; copying it");
+    if (view.width() != result.width() || 2 * view.height() != result.height())
+        return false;
+    view.convertTo(QImage::Format_RGB32);
+    for (int y = 0; y < view.height(); y++)
+        std::memcpy(result.scanLine(firstLine + y), view.constScanLine(y), view.width() * 4);
+    return true;
+}
+
+}
+
+bool mpoFindStereoPair(QByteArrayView data, QByteArrayView& left, QByteArrayView& right)
+{
+    const uchar* d = reinterpret_cast<const uchar*>(data.data());
+    qsizetype size = data.size();
+    qsizetype header = findMpHeader(d, size);
+    if (header < 0 || header + 8 > size)
+        return false;
+    bool bigEndian;
+    if (std::memcmp(d + header, "MM\0\x2a", 4) == 0)
+        bigEndian = true;
+    else if (std::memcmp(d + header, "II\x2a\0", 4) == 0)
+        bigEndian = false;
+    else
+        return false;
+
+    // MP Index IFD
+    qsizetype ifd = header + get32(d + header + 4, bigEndian);
+    if (ifd < header + 8 || ifd + 2 > size)
+        return false;
+    int ifdEntries = get16(d + ifd, bigEndian);
+    if (ifd + 2 + 12 * qsizetype(ifdEntries) > size)
+        return false;
+    quint32 imageCount = 0;
+    quint32 mpEntryBytes = 0;
+    quint32 mpEntryOffset = 0;
+    for (int i = 0; i < ifdEntries; i++) {
+        const uchar* e = d + ifd + 2 + 12 * i;
+        quint16 tag = get16(e, bigEndian);
+        if (tag == 0xb001) {
+            imageCount = get32(e + 8, bigEndian);
+        } else if (tag == 0xb002) {
+            mpEntryBytes = get32(e + 4, bigEndian);
+            mpEntryOffset = get32(e + 8, bigEndian);
+        }
+    }
+    if (imageCount < 2 || mpEntryBytes / 16 < imageCount)
+        return false;
+    qsizetype entries = header + mpEntryOffset;
+    if (entries < header + 8 || entries + 16 * qsizetype(imageCount) > size)
+        return false;
+
+    // Use the first two disparity images, or the first two images if there are none
+    QList<QByteArrayView> views;
+    QList<QByteArrayView> disparityViews;
+    for (quint32 i = 0; i < imageCount; i++) {
+        const uchar* e = d + entries + 16 * i;
+        quint32 attributes = get32(e, bigEndian);
+        qsizetype imageSize = get32(e + 4, bigEndian);
+        quint32 imageOffset = get32(e + 8, bigEndian);
+        qsizetype start = (imageOffset == 0 ? 0 : header + imageOffset);
+        if (imageSize < 4 || start + imageSize > size) {
+            LOG_DEBUG("MPO image %u is out of bounds", i);
+            continue;
+        }
+        QByteArrayView view(data.data() + start, imageSize);
+        views.append(view);
+        if ((attributes & 0xffffff) == 0x020002)
+            disparityViews.append(view);
+    }
+    const QList<QByteArrayView>& pair = (disparityViews.size() >= 2 ? disparityViews : views);
+    if (pair.size() < 2)
+        return false;
+    left = pair[0];
+    right = pair[1];
+    return true;
+}
+
+QImage decodeMpo(const QByteArray& data)
+{
+    QByteArrayView left, right;
+    if (!mpoFindStereoPair(data, left, right)) {
+        LOG_DEBUG("decodeMpo: no valid MP index");
+        return QImage();
+    }
+    QSize size = viewSize(left);
+    if (!size.isValid() || viewSize(right) != size) {
+        LOG_DEBUG("decodeMpo: views are incompatible");
+        return QImage();
+    }
+
+    // Decode both views concurrently, each directly into its half of the result
+    QImage result(size.width(), 2 * size.height(), QImage::Format_RGB32);
+    if (result.isNull())
+        return QImage();
+    QImage top(result.scanLine(0), size.width(), size.height(), result.bytesPerLine(), QImage::Format_RGB32);
+    QImage bottom(result.scanLine(size.height()), size.width(), size.height(), result.bytesPerLine(), QImage::Format_RGB32);
+    bool rightOk = false;
+    QThread* rightThread = QThread::create([&]() { rightOk = decodeView(right, bottom); });
+    rightThread->start();
+    bool leftOk = decodeView(left, top);
+    rightThread->wait();
+    delete rightThread;
+    if (!leftOk || !rightOk) {
+        LOG_DEBUG("decodeMpo: cannot decode views");
+        return QImage();
+    }
+    if (!placeView(top, result, 0) || !placeView(bottom, result, size.height())) {
+        LOG_DEBUG("decodeMpo: decoded views are incompatible");
+        return QImage();
+    }
+    return result;
+}
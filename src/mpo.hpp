@@ -0,0 +1,37 @@
+/*
+ * This file is part of Bino, a 3D video player.
+ *
+ * Copyright (C) 2026
+ * Martin Lambers <marlam@marlam.de>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QImage>
+
+
+/* Find the left and right view of a stereo MPO file via the MP Index IFD
+ * in the APP2 segment of the first image (CIPA DC-007). The views refer to
+ * the given data. Returns false if the data has no valid MP Index. */
+bool mpoFindStereoPair(QByteArrayView data, QByteArrayView& left, QByteArrayView& right);
+
+/* Decode a stereo MPO file into a top-bottom image (left view on top).
+ * Both views are decoded concurrently, directly into their half of the
+ * result. Returns a null image if the data does not contain two
+ * compatible views. This is thread-safe. */
+QImage decodeMpo(const QByteArray& data);
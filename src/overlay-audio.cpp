@@ -58,14 +58,17 @@ bool OverlayAudio::redraw(int w, int h)
 {
     if (_currentString.isEmpty())
         w = h = 1;
-    bool redraw = resize(w, h);
-    if (_currentString != _lastString)
-        redraw = true;
-
-    if (!redraw)
+    bool resized = resize(w, h);
+    if (!resized && _currentString == _lastString)
         return false;
 
-    clear();
+    // only the area of the previous text needs to be cleared
+    if (resized)
+        clear();
+    else
+        clear(_lastBounds);
+    _lastBounds = QRect();
+    _lastString = _currentString;
 
     if (_currentString.isEmpty())
         return true;
@@ -108,7 +111,9 @@ bool OverlayAudio::redraw(int w, int h)
     range.format.setForeground(Qt::white);
     layout.draw(painter(), {}, { range });
 
-    _lastString = _currentString;
+    float boundsMargin = fontSize / 4.0f;
+    _lastBounds = markDirty(layout.boundingRect().translated(layout.position())
+            .marginsAdded(QMarginsF(boundsMargin, boundsMargin, boundsMargin, boundsMargin)));
     return true;
 }
 
@@ -29,6 +29,7 @@ class OverlayAudio : public Overlay
 private:
     QString _currentString;
     QString _lastString;
+    QRect _lastBounds;
 
     friend QDataStream &operator<<(QDataStream& ds, const OverlayAudio& o);
     friend QDataStream &operator>>(QDataStream& ds, OverlayAudio& o);
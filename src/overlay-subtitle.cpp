@@ -21,11 +21,18 @@
 #include <QFont>
 #include <QFontMetrics>
 #include <QTextLayout>
+#include <QGlyphRun>
 
 #include "overlay-subtitle.hpp"
+#include "log.hpp"
 
 
-OverlaySubtitle::OverlaySubtitle()
+static const int layoutCacheSize = 64; // subtitle strings
+
+OverlaySubtitle::OverlaySubtitle() :
+    _width(0),
+    _height(0),
+    _layoutCacheGeneration(0)
 {
 }
 
@@ -38,19 +45,10 @@ void OverlaySubtitle::updateParameters(const QString& string)
     _currentString = string;
 }
 
-bool OverlaySubtitle::redraw(int w, int h)
+bool OverlaySubtitle::layout(const QString& string, QVector<OverlaySubtitleGlyph>& glyphs)
 {
-    bool redraw = resize(w, h);
-    if (_currentString != _lastString)
-        redraw = true;
-
-    if (!redraw)
-        return false;
-
-    clear();
-
-    if (_currentString.isEmpty())
-        return true;
+    int w = _width;
+    int h = _height;
 
     // this tries to reproduce what qvideotexturehelper.cpp does since it is entirely
     // unclear and undocumented how subtitles are expected to be handled
@@ -59,7 +57,7 @@ bool OverlaySubtitle::redraw(int w, int h)
     float fontSize = h * 0.045f;
     font.setPointSize(fontSize);
     QTextLayout layout;
-    layout.setText(_currentString);
+    layout.setText(string);
     layout.setFont(font);
     QTextOption option;
     option.setUseDesignMetrics(true);
@@ -69,7 +67,6 @@ bool OverlaySubtitle::redraw(int w, int h)
     float lineWidth = w * 0.9f;
     float margin = w * 0.05f;
     float height = 0.0f;
-    float textWidth = 0.0f;
     layout.beginLayout();
     for (;;) {
         QTextLine line = layout.createLine();
@@ -79,21 +76,68 @@ bool OverlaySubtitle::redraw(int w, int h)
         height += metrics.leading();
         line.setPosition(QPointF(margin, height));
         height += line.height();
-        textWidth = qMax(textWidth, line.naturalTextWidth());
     }
     layout.endLayout();
     int bottomMargin = h / 20;
     float y = h - bottomMargin - height;
-    layout.setPosition(QPointF(0.0f, y));
-    textWidth += fontSize / 4.0f;
-    //QRectF bounds = QRectF((w - textWidth) * 0.5f, y, textWidth, height);
 
-    QTextLayout::FormatRange range;
-    range.start = 0;
-    range.length = layout.text().size();
-    range.format.setForeground(Qt::white);
-    layout.draw(painter(), {}, { range });
+    glyphs.clear();
+    const QList<QGlyphRun> glyphRuns = layout.glyphRuns();
+    for (const QGlyphRun& run : glyphRuns) {
+        QRawFont rawFont = run.rawFont();
+        float scale = rawFont.pixelSize() / GlyphAtlas::baseSize;
+        const QList<quint32> indexes = run.glyphIndexes();
+        const QList<QPointF> positions = run.positions();
+        for (qsizetype i = 0; i < indexes.size(); i++) {
+            GlyphAtlas::Glyph g;
+            if (!_atlas.glyph(rawFont, indexes[i], &g))
+                return false;
+            if (g.rect.isEmpty())
+                continue;
+            OverlaySubtitleGlyph q;
+            q.rect[0] = positions[i].x() + g.rect.x() * scale;
+            q.rect[1] = positions[i].y() + y + g.rect.y() * scale;
+            q.rect[2] = g.rect.width() * scale;
+            q.rect[3] = g.rect.height() * scale;
+            q.atlasRect[0] = g.atlasRect.x();
+            q.atlasRect[1] = g.atlasRect.y();
+            q.atlasRect[2] = g.atlasRect.width();
+            q.atlasRect[3] = g.atlasRect.height();
+            glyphs.append(q);
+        }
+    }
+    return true;
+}
 
+bool OverlaySubtitle::update(int w, int h)
+{
+    bool resized = (w != _width || h != _height);
+    if (!resized && _currentString == _lastString)
+        return false;
+    _width = w;
+    _height = h;
     _lastString = _currentString;
+
+    // cached layouts are valid for one size and one atlas generation
+    if (resized || _layoutCacheGeneration != _atlas.generation() || _layoutCache.size() >= layoutCacheSize) {
+        _layoutCache.clear();
+        _layoutCacheGeneration = _atlas.generation();
+    }
+    auto it = _layoutCache.constFind(_currentString);
+    if (it != _layoutCache.constEnd()) {
+        _glyphs = it.value();
+        return true;
+    }
+    if (!layout(_currentString, _glyphs)) {
+        // the atlas is full; start over with only the glyphs of this string
+        _atlas.clear();
+        _layoutCache.clear();
+        _layoutCacheGeneration = _atlas.generation();
+        if (!layout(_currentString, _glyphs)) {
+            LOG_WARNING("subtitle has too many different glyphs");
+            _glyphs.clear();
+        }
+    }
+    _layoutCache.insert(_currentString, _glyphs);
     return true;
 }
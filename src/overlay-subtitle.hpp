@@ -20,14 +20,36 @@
 
 #pragma once
 
-#include "overlay.hpp"
+#include <QString>
+#include <QHash>
+#include <QVector>
 
+#include "glyphatlas.hpp"
 
-class OverlaySubtitle : public Overlay
+
+/* Subtitles are drawn on the GPU as a batch of glyph quads that sample
+ * a signed distance field glyph atlas. The layout of each subtitle string
+ * is computed only once for the current size. */
+
+/* One glyph quad; the layout must match the instance attributes of shader-glyph.vert.glsl */
+struct OverlaySubtitleGlyph
+{
+    float rect[4];      // x, y, width, height in pixels; origin is top left
+    float atlasRect[4]; // x, y, width, height in atlas texture coordinates
+};
+
+class OverlaySubtitle
 {
 private:
+    int _width, _height;
     QString _currentString;
     QString _lastString;
+    GlyphAtlas _atlas;
+    QHash<QString, QVector<OverlaySubtitleGlyph>> _layoutCache;
+    unsigned int _layoutCacheGeneration;
+    QVector<OverlaySubtitleGlyph> _glyphs;
+
+    bool layout(const QString& string, QVector<OverlaySubtitleGlyph>& glyphs);
 
 public:
     OverlaySubtitle();
@@ -35,5 +57,29 @@ public:
 
     void updateParameters(const QString& string);
 
-    virtual bool redraw(int w, int h) override;
+    /* Update the glyph quads for the given view size.
+     * Returns true if they changed and the subtitle needs to be drawn again. */
+    bool update(int w, int h);
+
+    // The size of the subtitle texture
+    int width() const
+    {
+        return _width;
+    }
+
+    int height() const
+    {
+        return _height;
+    }
+
+    // The glyph quads
+    const QVector<OverlaySubtitleGlyph>& glyphs() const
+    {
+        return _glyphs;
+    }
+
+    GlyphAtlas& atlas()
+    {
+        return _atlas;
+    }
 };
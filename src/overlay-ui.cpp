@@ -18,14 +18,14 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <QIcon>
-
 #include "overlay-ui.hpp"
 #include "bino.hpp"
 #include "playlist.hpp"
 
 
 OverlayUI::OverlayUI() :
+    _width(0),
+    _height(0),
     _lastSurround(false),
     _lastStereo3D(false),
     _lastPosition(-1),
@@ -34,7 +34,8 @@ OverlayUI::OverlayUI() :
     _lastPlaying(false),
     _lastPointer(-1.0f, -1.0f),
     _lastShowPointer(false),
-    _boxIsActive { false, false, false, false, false, false, false, false, false, false }
+    _boxIsActive { false, false, false, false, false, false, false, false, false, false },
+    _quadCount(0)
 {
 }
 
@@ -48,18 +49,18 @@ void OverlayUI::computeBoxes()
     float xFactor = 1.0f;
     float yOffset = 0.0f;
     if (_currentSurround) {
-        xOffset = 0.25f * image().width();
+        xOffset = 0.25f * _width;
         xFactor = 0.5f;
-        yOffset = -0.3f * image().height();
+        yOffset = -0.3f * _height;
     }
-    _buttonSize = image().width() / 18.0f * xFactor;
+    _buttonSize = _width / 18.0f * xFactor;
 
     _penWidth = _buttonSize / 10.0f;
     bool isReallySeekable = (_currentSeekable && _currentDuration > 0 && _currentPosition >= 0);
 
     // 9 buttons
     float x = 0.5f * _buttonSize + xOffset;
-    float y = image().height() - 2.5f * _buttonSize + yOffset;
+    float y = _height - 2.5f * _buttonSize + yOffset;
     for (int i = 0; i < 9; i++) {
         _boxIsActive[i] = true;
         if (i == 0 || i == 8) {
@@ -78,14 +79,14 @@ void OverlayUI::computeBoxes()
 
     // seek bar
     float barX = 0.5f * _buttonSize + xOffset;
-    float barY = image().height() - _buttonSize + yOffset;
-    float barW = image().width() - 2.0f * barX;
+    float barY = _height - _buttonSize + yOffset;
+    float barW = _width - 2.0f * barX;
     float barH = 0.5f * _buttonSize;
     _boxes[9] = QRectF(barX, barY, barW, barH);
     _boxIsActive[9] = isReallySeekable;
 
     // background
-    _boxes[10] = QRectF(xOffset, image().height() - 3.0f * _buttonSize + yOffset, image().width() - 2.0f * xOffset, 3.0f * _buttonSize);
+    _boxes[10] = QRectF(xOffset, _height - 3.0f * _buttonSize + yOffset, _width - 2.0f * xOffset, 3.0f * _buttonSize);
     _boxIsActive[10] = false;
     for (int i = 0; i < 10; i++) {
         if (_boxIsActive[i]) {
@@ -97,7 +98,7 @@ void OverlayUI::computeBoxes()
 
 QPointF OverlayUI::pointerToImage(const QPointF& pointer)
 {
-    return QPointF(pointer.x() * image().width(), pointer.y() * image().height());
+    return QPointF(pointer.x() * _width, pointer.y() * _height);
 }
 
 int OverlayUI::boxIndex(const QPointF& pointer)
@@ -110,11 +111,18 @@ int OverlayUI::boxIndex(const QPointF& pointer)
     return -1;
 }
 
+QRectF OverlayUI::pointerRect(const QPointF& pointer)
+{
+    QPointF p = pointerToImage(pointer);
+    float r = 2.5f * _penWidth + 1.0f; // radius plus half the pen width plus antialiasing
+    return QRectF(p.x() - r, p.y() - r, 2.0f * r, 2.0f * r);
+}
+
 float OverlayUI::pointerToSeekPos(const QPointF& pointer)
 {
     // this assumes that the pointer is inside _boxes[9]
     QPointF p = pointerToImage(pointer);
-    float seekPos = (p.x() - (_boxes[9].x() + 0.5f * _penWidth)) / (image().width() - 2.0f * (_boxes[9].x() + 0.5f * _penWidth));
+    float seekPos = (p.x() - (_boxes[9].x() + 0.5f * _penWidth)) / (_width - 2.0f * (_boxes[9].x() + 0.5f * _penWidth));
     if (seekPos < 0.0f)
         seekPos = 0.0f;
     else if (seekPos > 1.0f)
@@ -136,98 +144,89 @@ void OverlayUI::updateParameters(bool surround, bool stereo3D,
     _currentShowPointer = showPointer;
 }
 
-bool OverlayUI::redraw(int w, int h)
+void OverlayUI::addQuad(const QRectF& rect, const float* color, Shape shape, float param0, float param1)
+{
+    OverlayUIQuad& q = _block.quads[_quadCount++];
+    q.rect[0] = rect.x();
+    q.rect[1] = rect.y();
+    q.rect[2] = rect.width();
+    q.rect[3] = rect.height();
+    for (int i = 0; i < 4; i++)
+        q.color[i] = color[i];
+    q.params[0] = shape;
+    q.params[1] = _penWidth;
+    q.params[2] = param0;
+    q.params[3] = param1;
+}
+
+bool OverlayUI::update(int w, int h)
 {
     if (_currentSurround) {
         int d = qMin(w, h);
         w = h = d;
     }
-    bool redraw = resize(w, h);
-    if (_currentSurround != _lastSurround
-            || _currentStereo3D != _lastStereo3D
-            || _currentPosition != _lastPosition
-            || _currentDuration != _lastDuration
-            || _currentSeekable != _lastSeekable
-            || _currentPlaying != _lastPlaying
-            || _currentPointer != _lastPointer
-            || _currentShowPointer != _lastShowPointer) {
-        redraw = true;
-    }
-
-    if (!redraw)
+    if (w == _width && h == _height
+            && _currentSurround == _lastSurround
+            && _currentStereo3D == _lastStereo3D
+            && _currentPosition == _lastPosition
+            && _currentDuration == _lastDuration
+            && _currentSeekable == _lastSeekable
+            && _currentPlaying == _lastPlaying
+            && _currentPointer == _lastPointer
+            && _currentShowPointer == _lastShowPointer) {
         return false;
-
-    clear();
+    }
+    _width = w;
+    _height = h;
 
     computeBoxes();
     int highlightedBox = boxIndex(_currentPointer);
 
-    QColor normalColor = Qt::black;
-    normalColor.setAlphaF(0.7f);
-    QColor highlightColor = Qt::red;
-    highlightColor.setAlphaF(0.7f);
-    QPen normalPen(Qt::white);
-    normalPen.setWidthF(_penWidth);
-    QPen highlightPen(Qt::red);
-    highlightPen.setWidthF(_penWidth);
+    // colors are linear RGB
+    const float backgroundColor[4] = { 0.0331f, 0.0331f, 0.0331f, 1.0f };
+    const float normalColor[4] = { 0.0f, 0.0f, 0.0f, 0.7f };
+    const float highlightColor[4] = { 1.0f, 0.0f, 0.0f, 0.7f };
+    const float pointerColor[4] = { 1.0f, 0.0f, 0.0f, 1.0f };
+
+    _block.viewport[0] = w;
+    _block.viewport[1] = h;
+    _block.viewport[2] = 0.0f;
+    _block.viewport[3] = 0.0f;
+    _quadCount = 0;
 
     // background
     if (_boxIsActive[10]) {
-        painter()->fillRect(_boxes[10], QColor(51, 51, 51));
+        addQuad(_boxes[10], backgroundColor, Shape_Rect);
     }
 
     // 9 buttons
     for (int i = 0; i < 9; i++) {
         if (_boxIsActive[i]) {
-            QString iconName = "media-";
+            Shape shape;
             float iconFactor = 1.0f;
             if (i == 0 || i == 8) {
-                iconName += "skip-";
-                iconName += i < 4 ? "backward" : "forward";
+                shape = (i < 4 ? Shape_ButtonSkipBackward : Shape_ButtonSkipForward);
                 iconFactor = 0.8f;
             } else if (i == 4) {
-                iconName += "playback-";
-                iconName += _currentPlaying ? "pause" : "start";
+                shape = (_currentPlaying ? Shape_ButtonPause : Shape_ButtonPlay);
             } else {
-                iconName += "seek-";
-                iconName += i < 4 ? "backward" : "forward";
+                shape = (i < 4 ? Shape_ButtonSeekBackward : Shape_ButtonSeekForward);
                 iconFactor = 0.2f + qAbs(i - 4) * 0.2f;
             }
-            painter()->fillRect(_boxes[i], i == highlightedBox ? highlightColor : normalColor);
-            QIcon icon = QIcon::fromTheme(iconName);
-            float d = 0.5f * (_buttonSize * iconFactor - _buttonSize);
-            QRectF iconRect = _boxes[i].marginsAdded(QMarginsF(d, d, d, d));
-            painter()->setPen(i == highlightedBox ? highlightPen : normalPen);
-            icon.paint(painter(), iconRect.toRect(), Qt::AlignCenter, QIcon::Active, QIcon::On);
+            addQuad(_boxes[i], i == highlightedBox ? highlightColor : normalColor, shape, iconFactor);
         }
     }
 
     // seek bar
     if (_boxIsActive[9]) {
-        QRectF barRect = _boxes[9];
-        painter()->fillRect(barRect, 9 == highlightedBox ? highlightColor : normalColor);
-        painter()->setPen(normalPen);
-        painter()->drawLine(QLineF(barRect.x() + _penWidth, barRect.y() + 0.25f * _buttonSize,
-                    barRect.x() + barRect.width() - _penWidth, barRect.y() + 0.25f * _buttonSize));
         float posF = _currentPosition / float(_currentDuration);
-        float barPosX = barRect.x() + 0.5f * _penWidth + posF * (barRect.width() - _penWidth);
-        painter()->drawLine(QLineF(barPosX, barRect.y() + _penWidth,
-                    barPosX, barRect.y() + barRect.height() - _penWidth));
-        if (9 == highlightedBox) {
-            painter()->setPen(highlightPen);
-            posF = pointerToSeekPos(_currentPointer);
-            float barPosX = barRect.x() + 0.5f * _penWidth + posF * (barRect.width() - _penWidth);
-            painter()->drawLine(QLineF(barPosX, barRect.y() + _penWidth,
-                        barPosX, barRect.y() + barRect.height() - _penWidth));
-        }
+        float highlightPosF = (9 == highlightedBox ? pointerToSeekPos(_currentPointer) : -1.0f);
+        addQuad(_boxes[9], 9 == highlightedBox ? highlightColor : normalColor, Shape_SeekBar, posF, highlightPosF);
     }
 
     // pointer
     if (_currentShowPointer) {
-        painter()->setPen(highlightPen);
-        painter()->drawEllipse(
-                QPointF(_currentPointer.x() * w, _currentPointer.y() * h),
-                _penWidth * 2.0f, _penWidth * 2.0f);
+        addQuad(pointerRect(_currentPointer), pointerColor, Shape_Pointer);
     }
 
     _lastSurround = _currentSurround;
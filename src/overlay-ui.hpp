@@ -21,13 +21,48 @@
 #pragma once
 
 #include <QRectF>
+#include <QDataStream>
 
-#include "overlay.hpp"
 
+/* The overlay UI is drawn on the GPU: each element (background, buttons with
+ * their icons, seek bar, pointer) is one instance of a quad, and the shape is
+ * computed in the fragment shader from signed distance functions.
+ * The elements are described by a uniform block, see shader-ui.*.glsl.
+ * The layout of these structures must match that block (std140). */
 
-class OverlayUI : public Overlay
+struct OverlayUIQuad
 {
+    float rect[4];      // x, y, width, height in pixels; origin is top left
+    float color[4];     // linear RGB and alpha
+    float params[4];    // shape, pen width, and two shape-specific parameters
+};
+
+static const int OverlayUIMaxQuads = 16;
+
+struct OverlayUIBlock
+{
+    float viewport[4];  // width, height, unused, unused
+    OverlayUIQuad quads[OverlayUIMaxQuads];
+};
+
+class OverlayUI
+{
+public:
+    // The shapes; must match shader-ui.frag.glsl
+    enum Shape {
+        Shape_Rect = 0,
+        Shape_ButtonPlay = 1,
+        Shape_ButtonPause = 2,
+        Shape_ButtonSeekBackward = 3,
+        Shape_ButtonSeekForward = 4,
+        Shape_ButtonSkipBackward = 5,
+        Shape_ButtonSkipForward = 6,
+        Shape_SeekBar = 7,
+        Shape_Pointer = 8
+    };
+
 private:
+    int _width, _height;
     bool _currentSurround;
     bool _currentStereo3D;
     qint64 _currentPosition;
@@ -50,10 +85,15 @@ private:
     QRectF _boxes[11];
     bool _boxIsActive[11];
 
+    OverlayUIBlock _block;
+    int _quadCount;
+
     void computeBoxes();
     QPointF pointerToImage(const QPointF& pointer);
     int boxIndex(const QPointF& pointer);
+    QRectF pointerRect(const QPointF& pointer);
     float pointerToSeekPos(const QPointF& pointer);
+    void addQuad(const QRectF& rect, const float* color, Shape shape, float param0 = 0.0f, float param1 = 0.0f);
 
     friend QDataStream &operator<<(QDataStream& ds, const OverlayUI& o);
     friend QDataStream &operator>>(QDataStream& ds, OverlayUI& o);
@@ -66,7 +106,31 @@ public:
             qint64 position, qint64 duration, bool seekable,
             bool playing, const QPointF& pointer, bool showPointer);
 
-    virtual bool redraw(int w, int h) override;
+    /* Update the UI elements for the given view size.
+     * Returns true if they changed and the UI needs to be drawn again. */
+    bool update(int w, int h);
+
+    // The size of the UI texture
+    int width() const
+    {
+        return _width;
+    }
+
+    int height() const
+    {
+        return _height;
+    }
+
+    // The UI elements
+    const OverlayUIBlock& block() const
+    {
+        return _block;
+    }
+
+    int quadCount() const
+    {
+        return _quadCount;
+    }
 
     bool pointerPress(const QPointF& pointer);
     void pointerRelease(const QPointF& pointer);
@@ -23,7 +23,7 @@
 #include "overlay.hpp"
 
 
-Overlay::Overlay() : _painter(nullptr)
+Overlay::Overlay() : _painter(nullptr), _sizeChanged(false)
 {
 }
 
@@ -40,6 +40,8 @@ bool Overlay::resize(int w, int h)
         _img = QImage(w, h, QImage::Format_ARGB32_Premultiplied);
         _painter = new QPainter(&_img);
         _painter->setRenderHint(QPainter::Antialiasing, true);
+        _sizeChanged = true;
+        _dirtyRect = _img.rect();
         return true;
     } else {
         return false;
@@ -51,4 +53,32 @@ void Overlay::clear()
     QColor clearColor = Qt::black;
     clearColor.setAlpha(0);
     _img.fill(clearColor);
+    _dirtyRect = _img.rect();
+}
+
+QRect Overlay::clear(const QRect& rect)
+{
+    QRect r = markDirty(rect);
+    _painter->save();
+    _painter->setClipping(false);
+    _painter->setCompositionMode(QPainter::CompositionMode_Source);
+    _painter->fillRect(r, Qt::transparent);
+    _painter->restore();
+    return r;
+}
+
+QRect Overlay::markDirty(const QRectF& rect)
+{
+    if (rect.isEmpty())
+        return QRect();
+    // one additional pixel for antialiasing
+    QRect r = rect.toAlignedRect().adjusted(-1, -1, 1, 1).intersected(_img.rect());
+    _dirtyRect |= r;
+    return r;
+}
+
+void Overlay::resetChanges()
+{
+    _sizeChanged = false;
+    _dirtyRect = QRect();
 }
@@ -22,17 +22,24 @@
 
 #include <QImage>
 #include <QPainter>
+#include <QRect>
 
 
+/* An overlay image that tracks which part of it changed, so that
+ * only this part needs to be uploaded to its texture. */
 class Overlay
 {
 private:
     QImage _img;
     QPainter* _painter;
+    bool _sizeChanged;
+    QRect _dirtyRect;
 
 protected:
-    bool resize(int w, int h);
-    void clear();
+    bool resize(int w, int h);      // marks the whole image as changed if the size changes
+    void clear();                   // clears the whole image and marks it as changed
+    QRect clear(const QRect& rect); // clears the rectangle and marks it as changed; returns the cleared rectangle
+    QRect markDirty(const QRectF& rect); // returns the pixel rectangle that covers rect
 
     QPainter* painter()
     {
@@ -49,4 +56,17 @@ public:
     {
         return _img;
     }
+
+    /* The changes since the last call to resetChanges() */
+    bool sizeChanged() const
+    {
+        return _sizeChanged;
+    }
+
+    const QRect& dirtyRect() const
+    {
+        return _dirtyRect;
+    }
+
+    void resetChanges();
 };
@@ -19,6 +19,7 @@
  */
 
 #include <QFile>
+#include <QDir>
 #include <QTextStream>
 #include <QCommandLineParser>
 
@@ -197,20 +198,71 @@ int Playlist::length() const
     return _entries.length();
 }
 
+int Playlist::currentIndex() const
+{
+    return _currentIndex;
+}
+
+int Playlist::upcomingIndex(int n) const
+{
+    if (_currentIndex < 0 || length() == 0)
+        return -1;
+    switch (loopMode()) {
+    case Loop_Off:
+        return (_currentIndex + n < length() ? _currentIndex + n : -1);
+    case Loop_One:
+        return _currentIndex;
+    case Loop_All:
+        return (_currentIndex + n) % length();
+    }
+    return -1;
+}
+
 void Playlist::append(const PlaylistEntry& entry)
 {
+    emit entriesAboutToBeInserted(length(), 1);
     _entries.append(entry);
+    emit entriesInserted();
 }
 
 void Playlist::insert(int index, const PlaylistEntry& entry)
 {
+    emit entriesAboutToBeInserted(index, 1);
     _entries.insert(index, entry);
+    if (_currentIndex >= index)
+        _currentIndex++;
+    emit entriesInserted();
+}
+
+void Playlist::replace(int index, const PlaylistEntry& entry)
+{
+    if (index >= 0 && index < length()) {
+        _entries[index] = entry;
+        emit entryChanged(index);
+    }
+}
+
+void Playlist::move(int from, int to)
+{
+    if (from >= 0 && from < length() && to >= 0 && to < length() && from != to) {
+        emit entryAboutToBeMoved(from, to);
+        _entries.move(from, to);
+        if (_currentIndex == from)
+            _currentIndex = to;
+        else if (from < _currentIndex && to >= _currentIndex)
+            _currentIndex--;
+        else if (from > _currentIndex && to <= _currentIndex)
+            _currentIndex++;
+        emit entryMoved();
+    }
 }
 
 void Playlist::remove(int index)
 {
     if (index >= 0 && index < length()) {
+        emit entriesAboutToBeRemoved(index, 1);
         _entries.remove(index);
+        emit entriesRemoved();
         if (_currentIndex == index) {
             if (_currentIndex >= length())
                 _currentIndex--;
@@ -223,7 +275,9 @@ void Playlist::remove(int index)
 
 void Playlist::clear()
 {
+    emit entriesAboutToBeReset();
     _entries.clear();
+    emit entriesReset();
     int prevIndex = _currentIndex;
     _currentIndex = -1;
     if (prevIndex >= 0)
@@ -347,11 +401,14 @@ void Playlist::setWaitModeAuto()
 void Playlist::mediaEnded()
 {
     if (waitMode() == Wait_Off) {
-        next();
+        if (loopMode() == Loop_Off && _currentIndex == length() - 1)
+            emit finished();
+        else
+            next();
     }
 }
 
-bool Playlist::save(const QString& fileName, QString& errStr) const
+bool Playlist::save(const QString& fileName, QString& errStr)
 {
     QFile file(fileName);
     if (!file.open(QIODeviceBase::WriteOnly | QIODeviceBase::Truncate | QIODeviceBase::Text)) {
@@ -365,7 +422,11 @@ bool Playlist::save(const QString& fileName, QString& errStr) const
         out << "#EXTINF:0,\n";
         out << "#EXTBINOOPT:" << entries()[i].optionsToString() << "\n";
         out << entries()[i].url.toString() << "\n";
+        if (i % 1000 == 999)
+            emit progress(i + 1, length());
     }
+    out.flush();
+    emit progress(length(), length());
     file.flush();
     file.close();
     if (file.error() != QFileDevice::NoError) {
@@ -376,6 +437,17 @@ bool Playlist::save(const QString& fileName, QString& errStr) const
 }
 
 
+static QUrl urlFromPlaylistLine(const QString& line)
+{
+    // QUrl::fromUserInput() looks at the file system, which is slow for
+    // large playlists, so handle the common cases directly.
+    if (line.contains("://"))
+        return QUrl(line);
+    if (QDir::isAbsolutePath(line))
+        return QUrl::fromLocalFile(line);
+    return QUrl::fromUserInput(line, QString("."), QUrl::AssumeLocalFile);
+}
+
 bool Playlist::load(const QString& fileName, QString& errStr)
 {
     QFile file(fileName);
@@ -388,9 +460,12 @@ bool Playlist::load(const QString& fileName, QString& errStr)
     PlaylistEntry entry;
     QTextStream in(&file);
     int lineIndex = 0;
-    while (!in.atEnd()) {
-        QString line = in.readLine();
+    QString line;
+    qint64 fileSize = file.size();
+    while (in.readLineInto(&line)) {
         lineIndex++;
+        if (lineIndex % 1000 == 0)
+            emit progress(file.pos(), fileSize);
         if (line.startsWith("#EXTBINOOPT: ")) {
             if (!entry.optionsFromString(line.mid(13))) {
                 LOG_DEBUG("%s line %d: ignoring invalid Bino options", qPrintable(fileName), lineIndex);
@@ -398,7 +473,7 @@ bool Playlist::load(const QString& fileName, QString& errStr)
         } else if (line.isEmpty() || line.startsWith("#")) {
             continue;
         } else {
-            entry.url = QUrl::fromUserInput(line, QString("."), QUrl::AssumeLocalFile);
+            entry.url = urlFromPlaylistLine(line);
             if (entry.url.isValid() && (
                         entry.url.scheme() == "file"
                         || entry.url.scheme() == "https"
@@ -411,8 +486,11 @@ bool Playlist::load(const QString& fileName, QString& errStr)
     }
     if (file.error() == QFileDevice::NoError) {
         // overwrite this playlist with new information
-        _entries = entries;
+        emit entriesAboutToBeReset();
+        _entries = std::move(entries);
         _currentIndex = -1;
+        emit entriesReset();
+        emit progress(fileSize, fileSize);
         return true;
     } else {
         errStr = file.errorString();
@@ -83,15 +83,19 @@ public:
     const QList<PlaylistEntry>& entries() const;
 
     int length() const;
+    int currentIndex() const;
+    int upcomingIndex(int n = 1) const; // index of the entry played n steps after the current one, or -1
     void append(const PlaylistEntry& entry);
-    void insert(int index, const PlaylistEntry& entry);
+    void insert(int index, const PlaylistEntry& entry); // the current index moves along with the current entry
+    void replace(int index, const PlaylistEntry& entry);
+    void move(int from, int to);
     void remove(int index);
     void clear();
 
     LoopMode loopMode() const;
     WaitMode waitMode() const;
 
-    bool save(const QString& fileName, QString& errStr) const;
+    bool save(const QString& fileName, QString& errStr); // not const since it emits progress()
     bool load(const QString& fileName, QString& errStr);
 
 public slots:
@@ -108,4 +112,17 @@ public slots:
 
 signals:
     void mediaChanged(PlaylistEntry entry);
+    void finished(); // the last entry ended and nothing follows
+    // changes of the list of entries, e.g. for PlaylistModel:
+    void entriesAboutToBeInserted(int index, int count);
+    void entriesInserted();
+    void entriesAboutToBeRemoved(int index, int count);
+    void entriesRemoved();
+    void entryAboutToBeMoved(int from, int to);
+    void entryMoved();
+    void entryChanged(int index);
+    void entriesAboutToBeReset();
+    void entriesReset();
+    // progress of load() and save()
+    void progress(qint64 done, qint64 total);
 };
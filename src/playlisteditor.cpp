@@ -22,7 +22,7 @@
 #include <QSpacerItem>
 #include <QPushButton>
 #include <QLabel>
-#include <QTableWidget>
+#include <QTableView>
 #include <QHeaderView>
 #include <QComboBox>
 #include <QFileDialog>
@@ -30,6 +30,7 @@
 
 #include "playlist.hpp"
 #include "playlisteditor.hpp"
+#include "playlistmodel.hpp"
 #include "modes.hpp"
 #include "metadata.hpp"
 
@@ -216,21 +217,18 @@ PlaylistEditor::PlaylistEditor(QWidget* parent) :
 
     QGridLayout* layout = new QGridLayout;
 
-    table = new QTableWidget(this);
-    table->setColumnCount(6);
-    table->setHorizontalHeaderLabels({
-            tr("URL"),
-            tr("Input Mode"),
-            tr("Surround Mode"),
-            tr("Video Track"),
-            tr("Audio Track"),
-            tr("Subtitle Track") });
+    model = new PlaylistModel(this);
+    table = new QTableView(this);
+    table->setModel(model);
     table->setSelectionMode(QAbstractItemView::SingleSelection);
     table->setSelectionBehavior(QAbstractItemView::SelectRows);
     table->horizontalHeader()->setHighlightSections(false);
     table->verticalHeader()->setHighlightSections(false);
-    table->resizeColumnsToContents();
-    connect(table, SIGNAL(itemSelectionChanged()), this, SLOT(updateButtonState()));
+    // fixed row heights, so that the view never needs to look at rows that are not visible
+    table->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    table->resizeColumnsToContents(); // this looks at a limited number of rows only
+    connect(table->selectionModel(), SIGNAL(selectionChanged(const QItemSelection&, const QItemSelection&)),
+            this, SLOT(updateButtonState()));
     layout->addWidget(table, 0, 0, 7, 7);
 
     upBtn = new QPushButton(tr("Move up"), this);
@@ -258,115 +256,80 @@ PlaylistEditor::PlaylistEditor(QWidget* parent) :
     layout->setRowStretch(0, 1);
     setLayout(layout);
 
-    updateTable();
     updateButtonState();
 }
 
-void PlaylistEditor::updateTable()
-{
-    const Playlist* playlist = Playlist::instance();
-    int row = table->currentRow();
-    table->clearContents();
-    table->setRowCount(playlist->length());
-    for (int i = 0; i < playlist->length(); i++) {
-        const PlaylistEntry& entry = playlist->entries()[i];
-        table->setItem(i, 0, new QTableWidgetItem(entry.url.toString()));
-        table->setItem(i, 1, new QTableWidgetItem(inputModeToStringUI(entry.inputMode)));
-        table->setItem(i, 2, new QTableWidgetItem(surroundModeToStringUI(entry.surroundMode)));
-        table->setItem(i, 3, new QTableWidgetItem(
-                    entry.videoTrack < 0 ? tr("default") :
-                    QString::number(entry.videoTrack)));
-        table->setItem(i, 4, new QTableWidgetItem(
-                    entry.audioTrack < 0 ? tr("default") :
-                    QString::number(entry.audioTrack)));
-        table->setItem(i, 5, new QTableWidgetItem(
-                    entry.subtitleTrack < -1 ? tr("none") :
-                    entry.subtitleTrack < 0 ? tr("default") :
-                    QString::number(entry.subtitleTrack)));
-        for (int j = 0; j < 6; j++)
-            table->item(i, j)->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled | Qt::ItemNeverHasChildren);
-    }
-    table->setCurrentCell(row, 0, QItemSelectionModel::Rows);
-    table->resizeColumnsToContents();
-}
-
 void PlaylistEditor::updateButtonState()
 {
     int row = selectedRow();
-    bool haveSelection = (row >= 0 && row < table->rowCount());
+    int rowCount = model->rowCount();
+    bool haveSelection = (row >= 0 && row < rowCount);
     upBtn->setEnabled(haveSelection && row > 0);
-    downBtn->setEnabled(haveSelection && row < table->rowCount() - 1);
+    downBtn->setEnabled(haveSelection && row < rowCount - 1);
     delBtn->setEnabled(haveSelection);
     editBtn->setEnabled(haveSelection);
 }
 
 int PlaylistEditor::selectedRow()
 {
-    QList<QTableWidgetItem*> selection = table->selectedItems();
-    return (selection.isEmpty() ? -1 : selection[0]->row());
+    QModelIndexList selection = table->selectionModel()->selectedRows();
+    return (selection.isEmpty() ? -1 : selection[0].row());
+}
+
+void PlaylistEditor::selectRow(int row)
+{
+    if (row >= 0 && row < model->rowCount()) {
+        table->selectRow(row);
+        table->scrollTo(model->index(row, 0));
+    }
+    updateButtonState();
 }
 
 void PlaylistEditor::up()
 {
     int row = selectedRow();
     if (row > 0) {
-        Playlist* playlist = Playlist::instance();
-        playlist->insert(row - 1, playlist->entries()[row]);
-        playlist->remove(row + 1);
-        updateTable();
-        table->setCurrentCell(row - 1, 0);
-        updateButtonState();
+        Playlist::instance()->move(row, row - 1);
+        selectRow(row - 1);
     }
 }
 
 void PlaylistEditor::down()
 {
     int row = selectedRow();
-    if (row < table->rowCount() - 1) {
-        Playlist* playlist = Playlist::instance();
-        playlist->insert(row + 2, playlist->entries()[row]);
-        playlist->remove(row);
-        updateTable();
-        table->setCurrentCell(row + 1, 0);
-        updateButtonState();
+    if (row >= 0 && row < model->rowCount() - 1) {
+        Playlist::instance()->move(row, row + 1);
+        selectRow(row + 1);
     }
 }
 
 void PlaylistEditor::add()
 {
     int row = selectedRow();
-    if (row < 0 || row > table->rowCount() - 1)
-        row = table->rowCount() - 1;
-    Playlist* playlist = Playlist::instance();
-    playlist->insert(row + 1, PlaylistEntry(QUrl("")));
-    updateTable();
-    table->setCurrentCell(row + 1, 0);
-    updateButtonState();
+    if (row < 0 || row > model->rowCount() - 1)
+        row = model->rowCount() - 1;
+    Playlist::instance()->insert(row + 1, PlaylistEntry(QUrl("")));
+    selectRow(row + 1);
     edit();
 }
 
 void PlaylistEditor::del()
 {
     int row = selectedRow();
-    if (row >= 0 && row < table->rowCount()) {
-        Playlist* playlist = Playlist::instance();
-        playlist->remove(row);
-        updateTable();
-        table->setCurrentCell(row, 0);
-        updateButtonState();
+    if (row >= 0 && row < model->rowCount()) {
+        Playlist::instance()->remove(row);
+        selectRow(row < model->rowCount() ? row : row - 1);
     }
 }
 
 void PlaylistEditor::edit()
 {
     int row = selectedRow();
-    if (row >= 0 && row < table->rowCount()) {
+    if (row >= 0 && row < model->rowCount()) {
         Playlist* playlist = Playlist::instance();
         PlaylistEntryEditor editor(playlist->entries()[row], this);
         if (editor.exec() == QDialog::Accepted) {
-            playlist->entries()[row] = editor.entry;
-            updateTable();
-            table->setCurrentCell(row, 0);
+            playlist->replace(row, editor.entry);
         }
     }
 }
@@ -24,7 +24,8 @@
 class QLabel;
 class QComboBox;
 class QPushButton;
-class QTableWidget;
+class QTableView;
+class PlaylistModel;
 
 #include "playlist.hpp"
 
@@ -59,15 +60,16 @@ class PlaylistEditor : public QDialog
 Q_OBJECT
 
 private:
-    QTableWidget* table;
+    PlaylistModel* model;
+    QTableView* table;
     QPushButton* upBtn;
     QPushButton* downBtn;
     QPushButton* addBtn;
     QPushButton* delBtn;
     QPushButton* editBtn;
 
-    void updateTable();
     int selectedRow();
+    void selectRow(int row);
 
 private slots:
     void updateButtonState();
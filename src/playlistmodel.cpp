@@ -0,0 +1,145 @@
+/*
+ * This file is part of Bino, a 3D video player.
+ *
+ * Copyright (C) 2026
+ * Martin Lambers <marlam@marlam.de>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "playlistmodel.hpp"
+#include "playlist.hpp"
+#include "modes.hpp"
+
+
+PlaylistModel::PlaylistModel(QObject* parent) : QAbstractTableModel(parent)
+{
+    Playlist* playlist = Playlist::instance();
+    connect(playlist, SIGNAL(entriesAboutToBeInserted(int, int)), this, SLOT(entriesAboutToBeInserted(int, int)));
+    connect(playlist, SIGNAL(entriesInserted()), this, SLOT(entriesInserted()));
+    connect(playlist, SIGNAL(entriesAboutToBeRemoved(int, int)), this, SLOT(entriesAboutToBeRemoved(int, int)));
+    connect(playlist, SIGNAL(entriesRemoved()), this, SLOT(entriesRemoved()));
+    connect(playlist, SIGNAL(entryAboutToBeMoved(int, int)), this, SLOT(entryAboutToBeMoved(int, int)));
+    connect(playlist, SIGNAL(entryMoved()), this, SLOT(entryMoved()));
+    connect(playlist, SIGNAL(entryChanged(int)), this, SLOT(entryChanged(int)));
+    connect(playlist, SIGNAL(entriesAboutToBeReset()), this, SLOT(entriesAboutToBeReset()));
+    connect(playlist, SIGNAL(entriesReset()), this, SLOT(entriesReset()));
+}
+
+void PlaylistModel::entriesAboutToBeInserted(int index, int count)
+{
+    beginInsertRows(QModelIndex(), index, index + count - 1);
+}
+
+void PlaylistModel::entriesInserted()
+{
+    endInsertRows();
+}
+
+void PlaylistModel::entriesAboutToBeRemoved(int index, int count)
+{
+    beginRemoveRows(QModelIndex(), index, index + count - 1);
+}
+
+void PlaylistModel::entriesRemoved()
+{
+    endRemoveRows();
+}
+
+void PlaylistModel::entryAboutToBeMoved(int from, int to)
+{
+    beginMoveRows(QModelIndex(), from, from, QModelIndex(), to > from ? to + 1 : to);
+}
+
+void PlaylistModel::entryMoved()
+{
+    endMoveRows();
+}
+
+void PlaylistModel::entryChanged(int index)
+{
+    emit dataChanged(this->index(index, 0), this->index(index, columnCount() - 1));
+}
+
+void PlaylistModel::entriesAboutToBeReset()
+{
+    beginResetModel();
+}
+
+void PlaylistModel::entriesReset()
+{
+    endResetModel();
+}
+
+int PlaylistModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : Playlist::instance()->length();
+}
+
+int PlaylistModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : 6;
+}
+
+QVariant PlaylistModel::data(const QModelIndex& index, int role) const
+{
+    if (role != Qt::DisplayRole || !index.isValid() || index.row() >= rowCount())
+        return QVariant();
+    const PlaylistEntry& entry = Playlist::instance()->entries()[index.row()];
+    switch (index.column()) {
+    case 0:
+        return entry.url.toString();
+    case 1:
+        return inputModeToStringUI(entry.inputMode);
+    case 2:
+        return surroundModeToStringUI(entry.surroundMode);
+    case 3:
+        return entry.videoTrack < 0 ? tr("default") : QString::number(entry.videoTrack);
+    case 4:
+        return entry.audioTrack < 0 ? tr("default") : QString::number(entry.audioTrack);
+    case 5:
+        return entry.subtitleTrack < -1 ? tr("none")
+            : entry.subtitleTrack < 0 ? tr("default")
+            : QString::number(entry.subtitleTrack);
+    }
+    return QVariant();
+}
+
+QVariant PlaylistModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole)
+        return QVariant();
+    if (orientation == Qt::Vertical)
+        return section + 1;
+    switch (section) {
+    case 0:
+        return tr("URL");
+    case 1:
+        return tr("Input Mode");
+    case 2:
+        return tr("Surround Mode");
+    case 3:
+        return tr("Video Track");
+    case 4:
+        return tr("Audio Track");
+    case 5:
+        return tr("Subtitle Track");
+    }
+    return QVariant();
+}
+
+Qt::ItemFlags PlaylistModel::flags(const QModelIndex&) const
+{
+    return Qt::ItemIsSelectable | Qt::ItemIsEnabled | Qt::ItemNeverHasChildren;
+}
@@ -0,0 +1,52 @@
+/*
+ * This file is part of Bino, a 3D video player.
+ *
+ * Copyright (C) 2026
+ * Martin Lambers <marlam@marlam.de>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QAbstractTableModel>
+
+
+/* A table model on top of the Playlist singleton. Cell contents are created
+ * only when a view asks for them, i.e. only for visible rows, and changes to
+ * the playlist are forwarded as row changes instead of full resets. */
+class PlaylistModel : public QAbstractTableModel
+{
+Q_OBJECT
+
+private slots:
+    void entriesAboutToBeInserted(int index, int count);
+    void entriesInserted();
+    void entriesAboutToBeRemoved(int index, int count);
+    void entriesRemoved();
+    void entryAboutToBeMoved(int from, int to);
+    void entryMoved();
+    void entryChanged(int index);
+    void entriesAboutToBeReset();
+    void entriesReset();
+
+public:
+    PlaylistModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+};
@@ -21,10 +21,12 @@
 layout(location = 0) in vec4 position;
 layout(location = 1) in vec2 texcoord;
 
+uniform vec4 texcoord_transform; // scale x, scale y, offset x, offset y
+
 smooth out vec2 vtexcoord;
 
 void main(void)
 {
-    vtexcoord = texcoord;
+    vtexcoord = texcoord * texcoord_transform.xy + texcoord_transform.zw;
     gl_Position = position;
 }
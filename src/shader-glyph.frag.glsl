@@ -0,0 +1,35 @@
+/*
+ * This file is part of Bino, a 3D video player.
+ *
+ * Copyright (C) 2026
+ * Martin Lambers <marlam@marlam.de>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+uniform sampler2D atlas;
+
+smooth in vec2 vtexcoord;
+
+layout(location = 0) out vec4 fcolor;
+
+void main(void)
+{
+    // the atlas stores 0.5 at the glyph outline and larger values inside;
+    // antialias over the width of one pixel
+    float d = texture(atlas, vtexcoord).r;
+    float w = 0.5 * fwidth(d);
+    float a = smoothstep(0.5 - w, 0.5 + w, d);
+    fcolor = vec4(1.0, 1.0, 1.0, a);
+}
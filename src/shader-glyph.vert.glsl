@@ -0,0 +1,37 @@
+/*
+ * This file is part of Bino, a 3D video player.
+ *
+ * Copyright (C) 2026
+ * Martin Lambers <marlam@marlam.de>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// per-glyph attributes; must match OverlaySubtitleGlyph in overlay-subtitle.hpp
+layout(location = 0) in vec4 rect;       // x, y, width, height in pixels; origin is top left
+layout(location = 1) in vec4 atlas_rect; // x, y, width, height in atlas texture coordinates
+
+uniform vec2 viewport; // width, height
+
+smooth out vec2 vtexcoord;
+
+void main(void)
+{
+    // a triangle strip with four vertices per glyph
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    vtexcoord = atlas_rect.xy + corner * atlas_rect.zw;
+    // the top of the subtitle is in the first texture row
+    vec2 p = rect.xy + corner * rect.zw;
+    gl_Position = vec4(2.0 * p / viewport - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,122 @@
+/*
+ * This file is part of Bino, a 3D video player.
+ *
+ * Copyright (C) 2026
+ * Martin Lambers <marlam@marlam.de>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// must match OverlayUIQuad and OverlayUIBlock in overlay-ui.hpp
+struct Quad {
+    vec4 rect;      // x, y, width, height in pixels; origin is top left
+    vec4 color;     // linear RGB and alpha
+    vec4 params;    // shape, pen width, and two shape-specific parameters
+};
+
+layout(std140) uniform UIBlock {
+    vec4 viewport;  // width, height, unused, unused
+    Quad quads[16];
+};
+
+flat in int vquad;
+smooth in vec2 vpixel;
+
+layout(location = 0) out vec4 fcolor;
+
+// the shapes; must match OverlayUI::Shape
+const int shape_rect = 0;
+const int shape_button_play = 1;
+const int shape_button_pause = 2;
+const int shape_button_seek_backward = 3;
+const int shape_button_seek_forward = 4;
+const int shape_button_skip_backward = 5;
+const int shape_button_skip_forward = 6;
+const int shape_seek_bar = 7;
+const int shape_pointer = 8;
+
+// signed distance to an axis-aligned box
+float sd_box(vec2 p, vec2 center, vec2 half_size)
+{
+    vec2 q = abs(p - center) - half_size;
+    return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0);
+}
+
+// signed distance to a triangle pointing right, with its left edge at x0 and its tip at x1;
+// exact inside and near the edges, which is all that antialiasing needs
+float sd_triangle_right(vec2 p, float x0, float x1, float half_height)
+{
+    vec2 n = normalize(vec2(half_height, x1 - x0)); // normal of the upper edge
+    float d_slanted = dot(vec2(p.x - x0, abs(p.y)), n) - half_height * n.y;
+    return max(x0 - p.x, d_slanted);
+}
+
+// icons in a unit square centered at the origin; backward icons mirror forward icons
+float icon_distance(int shape, vec2 p)
+{
+    if (shape == shape_button_seek_backward || shape == shape_button_skip_backward)
+        p.x = -p.x;
+    if (shape == shape_button_play) {
+        return sd_triangle_right(p, -0.3, 0.4, 0.4);
+    } else if (shape == shape_button_pause) {
+        return min(sd_box(p, vec2(-0.18, 0.0), vec2(0.1, 0.38)),
+                   sd_box(p, vec2(+0.18, 0.0), vec2(0.1, 0.38)));
+    } else if (shape == shape_button_seek_backward || shape == shape_button_seek_forward) {
+        return min(sd_triangle_right(p, -0.4, 0.0, 0.3),
+                   sd_triangle_right(p, 0.0, 0.4, 0.3));
+    } else {
+        return min(sd_triangle_right(p, -0.35, 0.2, 0.35),
+                   sd_box(p, vec2(0.28, 0.0), vec2(0.07, 0.35)));
+    }
+}
+
+// pixel coverage for a signed distance in pixels
+float coverage(float d)
+{
+    return clamp(0.5 - d, 0.0, 1.0);
+}
+
+void main(void)
+{
+    Quad q = quads[vquad];
+    int shape = int(q.params.x + 0.5);
+    float pen = q.params.y;
+    vec2 size = q.rect.zw;
+    vec4 color = q.color;
+    const vec4 white = vec4(1.0, 1.0, 1.0, 1.0);
+    const vec4 red = vec4(1.0, 0.0, 0.0, 1.0);
+    if (shape >= shape_button_play && shape <= shape_button_skip_forward) {
+        // box with icon; parameter: icon size relative to the box
+        float icon_size = q.params.z * size.x;
+        vec2 p = (vpixel - 0.5 * size) / icon_size;
+        color = mix(color, white, coverage(icon_distance(shape, p) * icon_size));
+    } else if (shape == shape_seek_bar) {
+        // box with line, position marker and optional seek marker;
+        // parameters: relative position and relative seek position (or -1)
+        vec2 center = 0.5 * size;
+        float c = coverage(sd_box(vpixel, center, vec2(0.5 * (size.x - pen), 0.5 * pen)));
+        float x = 0.5 * pen + q.params.z * (size.x - pen);
+        c = max(c, coverage(sd_box(vpixel, vec2(x, center.y), vec2(0.5 * pen, 0.5 * (size.y - pen)))));
+        color = mix(color, white, c);
+        if (q.params.w >= 0.0) {
+            x = 0.5 * pen + q.params.w * (size.x - pen);
+            color = mix(color, red, coverage(sd_box(vpixel, vec2(x, center.y), vec2(0.5 * pen, 0.5 * (size.y - pen)))));
+        }
+    } else if (shape == shape_pointer) {
+        // circle outline with a radius of two pen widths, centered in the quad
+        float d = abs(length(vpixel - 0.5 * size) - 2.0 * pen) - 0.5 * pen;
+        color.a *= coverage(d);
+    }
+    fcolor = color;
+}
@@ -0,0 +1,47 @@
+/*
+ * This file is part of Bino, a 3D video player.
+ *
+ * Copyright (C) 2026
+ * Martin Lambers <marlam@marlam.de>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// must match OverlayUIQuad and OverlayUIBlock in overlay-ui.hpp
+struct Quad {
+    vec4 rect;      // x, y, width, height in pixels; origin is top left
+    vec4 color;     // linear RGB and alpha
+    vec4 params;    // shape, pen width, and two shape-specific parameters
+};
+
+layout(std140) uniform UIBlock {
+    vec4 viewport;  // width, height, unused, unused
+    Quad quads[16];
+};
+
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texcoord;
+
+flat out int vquad;
+smooth out vec2 vpixel; // in pixels, relative to the top left corner of the quad
+
+void main(void)
+{
+    Quad q = quads[gl_InstanceID];
+    vquad = gl_InstanceID;
+    vpixel = texcoord * q.rect.zw;
+    // the top of the UI is in the first texture row
+    vec2 p = q.rect.xy + vpixel;
+    gl_Position = vec4(2.0 * p / viewport.xy - 1.0, 0.0, 1.0);
+}
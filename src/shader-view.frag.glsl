@@ -19,6 +19,11 @@
  */
 
 uniform sampler2D frameTex;
+uniform sampler2DArray frameTiles; // replaces frameTex for very large frames
+uniform vec2 tile_grid;   // number of tile columns and rows
+uniform vec2 tile_factor; // frame size divided by the tile stride
+uniform float tile_scale; // tile stride divided by the frame pixels covered by a layer
+uniform float tile_offset;// gutter divided by the frame pixels covered by a layer
 uniform sampler2D overlayTex0; // audio
 uniform sampler2D overlayTex1; // subtitle
 uniform sampler2D overlayTex2; // ui
@@ -33,6 +38,7 @@ uniform float view_offset_y;
 uniform float view_factor_y;
 int surroundDegrees = $SURROUND_DEGREES;
 const bool nonlinear_output = $NONLINEAR_OUTPUT;
+const bool tiled = $TILED;
 
 smooth in vec2 vtexcoord;
 smooth in vec3 vdirection;
@@ -53,6 +59,18 @@ vec3 rgb_to_nonlinear(vec3 rgb)
     return vec3(to_nonlinear(rgb.r), to_nonlinear(rgb.g), to_nonlinear(rgb.b));
 }
 
+// sample the frame tiles; the gradients refer to frame texture coordinates
+vec3 tile_lookup(vec2 uv, vec2 uvX, vec2 uvY)
+{
+    vec2 t = uv * tile_factor;
+    vec2 tile = clamp(floor(t), vec2(0.0), tile_grid - 1.0);
+    float layer = tile.y * tile_grid.x + tile.x;
+    // each layer holds its tile surrounded by a gutter
+    vec2 st = (t - tile) * tile_scale + tile_offset;
+    vec2 f = tile_factor * tile_scale;
+    return textureGrad(frameTiles, vec3(st, layer), uvX * f, uvY * f).rgb;
+}
+
 void main(void)
 {
     vec3 rgb = vec3(0.0, 0.0, 0.0);
@@ -88,7 +106,7 @@ void main(void)
         }
 #endif
         if (surroundDegrees == 360 || (phi >= -0.5 * pi && phi <= 0.5 * pi))
-            rgb = textureGrad(frameTex, uv, uvX, uvY).rgb;
+            rgb = tiled ? tile_lookup(vec2(fract(uv.x), uv.y), uvX, uvY) : textureGrad(frameTex, uv, uvX, uvY).rgb;
     } else {
         float vtx = (      vtexcoord.x - 0.5) / relative_width  + 0.5;
         float vty = (1.0 - vtexcoord.y - 0.5) / relative_height + 0.5;
@@ -96,7 +114,8 @@ void main(void)
         float y_inside = step(0.0, vty) * step(0.0, 1.0 - vty);
         float tx = view_offset_x + view_factor_x * vtx;
         float ty = view_offset_y + view_factor_y * vty;
-        rgb = x_inside * y_inside * texture(frameTex, vec2(tx, ty)).rgb;
+        vec2 txy = vec2(tx, ty);
+        rgb = x_inside * y_inside * (tiled ? tile_lookup(txy, dFdx(txy), dFdy(txy)) : texture(frameTex, txy).rgb);
     }
     if (showOverlayAudio) {
         vec4 ovl0 = texture(overlayTex0, vec2(overlay_x, overlay_y)).rgba;
@@ -0,0 +1,243 @@
+/*
+ * This file is part of Bino, a 3D video player.
+ *
+ * Copyright (C) 2026
+ * Martin Lambers <marlam@marlam.de>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <algorithm>
+
+#include <QJsonDocument>
+#include <QDateTime>
+#include <QUrl>
+
+#include "syncfollower.hpp"
+#include "bino.hpp"
+#include "log.hpp"
+
+
+static const int pingInterval = 100;            // milliseconds between sync commands
+static const int reconnectInterval = 1000;      // milliseconds between connection attempts
+static const int reportInterval = 10000;        // milliseconds between skew reports
+static const int roundTripHistory = 16;         // samples for the minimum round trip time
+static const double skewTolerance = 8.0;        // milliseconds; half a frame at 60 Hz
+static const double seekThreshold = 500.0;      // milliseconds; larger skews are corrected by seeking
+static const int seekSettleTime = 500;          // milliseconds to ignore measurements after a seek
+static const double correctionTime = 1000.0;    // milliseconds in which a skew is corrected via the rate
+static const double maxRateChange = 0.05;       // maximum deviation of the playback rate from 1
+
+static SyncFollower* syncFollowerSingleton = nullptr;
+
+SyncFollower::SyncFollower() :
+    _port(0),
+    _mediaMismatch(false),
+    _hasSkew(false),
+    _skew(0.0),
+    _roundTrip(0.0),
+    _clockOffset(0.0),
+    _reportSamples(0),
+    _reportSkewSum(0.0),
+    _reportSkewMax(0.0)
+{
+    Q_ASSERT(!syncFollowerSingleton);
+    syncFollowerSingleton = this;
+}
+
+SyncFollower::~SyncFollower()
+{
+    syncFollowerSingleton = nullptr;
+}
+
+SyncFollower* SyncFollower::instance()
+{
+    return syncFollowerSingleton;
+}
+
+bool SyncFollower::init(const QString& name)
+{
+    QStringList argList = name.split(':');
+    bool portOk = false;
+    if (argList.length() == 2)
+        _port = argList[1].toUShort(&portOk);
+    if (!portOk || argList[0].isEmpty()) {
+        LOG_FATAL("%s", qPrintable(tr("%1 is not of the form 'nameOrIP:port'").arg(name)));
+        return false;
+    }
+    _hostName = argList[0];
+
+    _socket.setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    connect(&_socket, &QTcpSocket::connected, [=]() {
+            LOG_INFO("%s", qPrintable(tr("Synchronizing to %1 port %2").arg(_hostName).arg(_port)));
+            _recentRoundTrips.clear();
+            _pingTimer.start(pingInterval);
+            });
+    connect(&_socket, &QTcpSocket::disconnected, [=]() {
+            LOG_WARNING("%s", qPrintable(tr("Lost connection to synchronization master %1 port %2").arg(_hostName).arg(_port)));
+            _pingTimer.stop();
+            _mediaMismatch = false;
+            _hasSkew = false;
+            Bino::instance()->setPlaybackRate(1.0);
+            _reconnectTimer.start(reconnectInterval);
+            });
+    connect(&_socket, &QTcpSocket::errorOccurred, [=]() {
+            LOG_DEBUG("sync: %s", qPrintable(_socket.errorString()));
+            if (_socket.state() == QAbstractSocket::UnconnectedState)
+                _reconnectTimer.start(reconnectInterval);
+            });
+    connect(&_socket, &QTcpSocket::readyRead, [=]() { readReplies(); });
+    connect(&_pingTimer, &QTimer::timeout, [=]() { sendPing(); });
+    _reconnectTimer.setSingleShot(true);
+    connect(&_reconnectTimer, &QTimer::timeout, [=]() { _socket.connectToHost(_hostName, _port); });
+    return true;
+}
+
+bool SyncFollower::isInitialized() const
+{
+    return !_hostName.isEmpty();
+}
+
+void SyncFollower::start()
+{
+    if (!isInitialized())
+        return;
+    _clock.start();
+    _reportTimer.start();
+    _socket.connectToHost(_hostName, _port);
+}
+
+bool SyncFollower::hasSkew() const
+{
+    return _hasSkew;
+}
+
+double SyncFollower::skew() const
+{
+    return _skew;
+}
+
+double SyncFollower::roundTripTime() const
+{
+    return _roundTrip;
+}
+
+double SyncFollower::clockOffset() const
+{
+    return _clockOffset;
+}
+
+void SyncFollower::sendPing()
+{
+    // do not pile up commands if the master does not keep up
+    if (_socket.bytesToWrite() > 0)
+        return;
+    _socket.write("sync " + QByteArray::number(_clock.elapsed()) + '\n');
+}
+
+void SyncFollower::readReplies()
+{
+    while (_socket.canReadLine()) {
+        QJsonDocument doc = QJsonDocument::fromJson(_socket.readLine());
+        if (doc.isObject())
+            handleReply(doc.object());
+    }
+}
+
+void SyncFollower::handleReply(const QJsonObject& reply)
+{
+    if (reply["reply"].toString() != "sync")
+        return;
+    qint64 roundTrip = _clock.elapsed() - reply["t0"].toInteger();
+    Bino* bino = Bino::instance();
+    QString state = reply["state"].toString();
+
+    // Follow the playlist entry, and do not correct anything while the media differ
+    QUrl masterUrl(reply["url"].toString());
+    if (state != "stopped" && masterUrl != bino->url()) {
+        _hasSkew = false;
+        if (bino->playbackRate() != 1.0)
+            bino->setPlaybackRate(1.0);
+        Playlist* playlist = Playlist::instance();
+        int masterIndex = reply["playlist_index"].toInt(-1);
+        if (masterIndex >= 0 && masterIndex < playlist->length()
+                && playlist->entries()[masterIndex].url == masterUrl) {
+            if (masterIndex != playlist->currentIndex()) {
+                LOG_DEBUG("sync: switching to playlist entry %d", masterIndex);
+                playlist->setCurrentIndex(masterIndex);
+            }
+        } else if (!_mediaMismatch) {
+            LOG_WARNING("%s", qPrintable(tr("Synchronization master plays %1, which is not in the playlist").arg(masterUrl.toString())));
+        }
+        _mediaMismatch = true;
+        return;
+    }
+    _mediaMismatch = false;
+
+    // Follow the playback state
+    if (state == "playing" && bino->paused())
+        bino->play();
+    else if (state == "paused" && bino->playing())
+        bino->pause();
+    if (state == "stopped" || bino->stopped() || bino->duration() <= 0) {
+        _hasSkew = false;
+        return;
+    }
+
+    // Ignore measurements that were delayed on the way, since their
+    // delay is not symmetric
+    _recentRoundTrips.append(roundTrip);
+    if (_recentRoundTrips.size() > roundTripHistory)
+        _recentRoundTrips.removeFirst();
+    qint64 minRoundTrip = *std::min_element(_recentRoundTrips.cbegin(), _recentRoundTrips.cend());
+    if (roundTrip > 2 * minRoundTrip + 5)
+        return;
+    if (_lastSeek.isValid() && _lastSeek.elapsed() < seekSettleTime)
+        return;
+
+    // Measure
+    double masterPosition = reply["position_ms"].toDouble();
+    if (state == "playing")
+        masterPosition += roundTrip / 2.0;
+    _skew = bino->position() - masterPosition;
+    _roundTrip = roundTrip;
+    _clockOffset = reply["clock_ms"].toDouble() - (QDateTime::currentMSecsSinceEpoch() - roundTrip / 2.0);
+    _hasSkew = true;
+    LOG_FIREHOSE("sync: skew %.1f ms, round trip %lld ms", _skew, roundTrip);
+    _reportSamples++;
+    _reportSkewSum += std::abs(_skew);
+    _reportSkewMax = std::max(_reportSkewMax, std::abs(_skew));
+    if (_reportTimer.elapsed() >= reportInterval) {
+        LOG_INFO("%s", qPrintable(tr("Synchronization skew: mean %1 ms, max %2 ms; round trip %3 ms; clock offset %4 ms")
+                    .arg(_reportSkewSum / _reportSamples, 0, 'f', 1).arg(_reportSkewMax, 0, 'f', 1)
+                    .arg(_roundTrip, 0, 'f', 1).arg(_clockOffset, 0, 'f', 1)));
+        _reportSamples = 0;
+        _reportSkewSum = 0.0;
+        _reportSkewMax = 0.0;
+        _reportTimer.start();
+    }
+
+    // Correct
+    double rate = 1.0;
+    if (std::abs(_skew) > seekThreshold || (state == "paused" && std::abs(_skew) > skewTolerance)) {
+        LOG_DEBUG("sync: seeking by %.1f ms", -_skew);
+        bino->seek(qint64(-_skew));
+        _lastSeek.start();
+    } else if (std::abs(_skew) > skewTolerance && state == "playing") {
+        rate = 1.0 - std::clamp(_skew / correctionTime, -maxRateChange, maxRateChange);
+    }
+    if (bino->playbackRate() != rate)
+        bino->setPlaybackRate(rate);
+}
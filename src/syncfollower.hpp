@@ -0,0 +1,83 @@
+/*
+ * This file is part of Bino, a 3D video player.
+ *
+ * Copyright (C) 2026
+ * Martin Lambers <marlam@marlam.de>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QTcpSocket>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QList>
+#include <QJsonObject>
+
+
+/* Keeps the playback of this instance synchronized to a master instance,
+ * i.e. any Bino instance that was started with --control-tcp.
+ *
+ * The follower periodically sends a 'sync' command with a timestamp of its
+ * own clock, and the master replies with its playback state, media position
+ * and wall-clock time, echoing the timestamp. Half the round trip time is the
+ * age of the master's position, so the clocks of the machines do not need to
+ * be synchronized. Small deviations are corrected by adjusting the playback
+ * rate, large ones by seeking. The reply also names the master's media; while
+ * it differs, the follower switches to the same playlist entry if it has one,
+ * and does not correct anything. */
+class SyncFollower : public QObject
+{
+Q_OBJECT
+
+private:
+    QString _hostName;
+    quint16 _port;
+    QTcpSocket _socket;
+    QTimer _pingTimer;
+    QTimer _reconnectTimer;
+    QElapsedTimer _clock;           // timestamps of the sync commands
+    QList<qint64> _recentRoundTrips;
+    QElapsedTimer _lastSeek;
+    bool _mediaMismatch;            // the master plays different media
+    bool _hasSkew;
+    double _skew;                   // own position minus master position, in milliseconds
+    double _roundTrip;              // in milliseconds
+    double _clockOffset;            // master wall clock minus own wall clock, in milliseconds
+    // for the periodic report:
+    QElapsedTimer _reportTimer;
+    int _reportSamples;
+    double _reportSkewSum;
+    double _reportSkewMax;
+
+    void sendPing();
+    void readReplies();
+    void handleReply(const QJsonObject& reply);
+
+public:
+    SyncFollower();
+    virtual ~SyncFollower();
+    static SyncFollower* instance();
+
+    bool init(const QString& name);
+    bool isInitialized() const;
+    void start();
+
+    // The last measurement, for monitoring
+    bool hasSkew() const;
+    double skew() const;
+    double roundTripTime() const;
+    double clockOffset() const;
+};
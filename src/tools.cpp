@@ -1,7 +1,7 @@
 /*
  * This file is part of Bino, a 3D video player.
  *
- * Copyright (C) 2022, 2023, 2024, 2025
+ * Copyright (C) 2022, 2023, 2024, 2025, 2026
  * Martin Lambers <marlam@marlam.de>
  *
  * This program is free software; you can redistribute it and/or modify
@@ -18,12 +18,18 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+
 #include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QLockFile>
 #include <QTextStream>
 #include <QOpenGLContext>
 #include <QOpenGLExtraFunctions>
 
 #include "tools.hpp"
+#include "log.hpp"
 
 
 OpenGL_Type OpenGLType;
@@ -56,6 +62,14 @@ bool checkTextureAnisotropicFilterAvailability()
         || QOpenGLContext::currentContext()->hasExtension("GL_EXT_texture_filter_anisotropic");
 }
 
+bool checkTextureStorageAvailability()
+{
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    return context->isOpenGLES()
+        || context->format().version() >= qMakePair(4, 2)
+        || context->hasExtension("GL_ARB_texture_storage");
+}
+
 const char* getOpenGLString(QOpenGLExtraFunctions* gl, GLenum p)
 {
     return reinterpret_cast<const char*>(gl->glGetString(p));
@@ -74,3 +88,53 @@ QString getExtension(const QUrl& url)
 {
     return getExtension(url.fileName());
 }
+
+void evictFromCache(const QString& dirName, const QStringList& nameFilters, qint64 budget, const QString& keepFileName)
+{
+    QDir dir(dirName);
+    QLockFile lock(dir.filePath(".lock"));
+    if (!lock.tryLock(1000)) {
+        LOG_DEBUG("%s", qPrintable(QString("cache %1 is locked; skipping eviction").arg(dirName)));
+        return;
+    }
+    QFileInfoList files = dir.entryInfoList(nameFilters, QDir::Files);
+    qint64 totalSize = 0;
+    for (const QFileInfo& fi : files)
+        totalSize += fi.size();
+    if (totalSize <= budget)
+        return;
+    std::sort(files.begin(), files.end(), [](const QFileInfo& a, const QFileInfo& b) {
+            return a.lastModified() < b.lastModified(); });
+    QString keep = QFileInfo(keepFileName).absoluteFilePath();
+    for (const QFileInfo& fi : files) {
+        if (totalSize <= budget)
+            break;
+        if (fi.absoluteFilePath() == keep)
+            continue;
+        // this may fail on systems where files in use cannot be removed; that's ok
+        if (QFile::remove(fi.absoluteFilePath())) {
+            LOG_DEBUG("%s", qPrintable(QString("evicted %1 from cache %2").arg(fi.fileName()).arg(dirName)));
+            totalSize -= fi.size();
+            const QStringList siblings = dir.entryList({ fi.completeBaseName() + ".*" }, QDir::Files);
+            for (const QString& sibling : siblings) {
+                qint64 siblingSize = QFileInfo(dir.filePath(sibling)).size();
+                if (QFile::remove(dir.filePath(sibling)) && QDir::match(nameFilters, sibling))
+                    totalSize -= siblingSize;
+            }
+        }
+    }
+}
+
+QByteArray mapFile(QFile& file)
+{
+    if (!file.isOpen() && !file.open(QIODeviceBase::ReadOnly))
+        return QByteArray();
+    qint64 size = file.size();
+    if (size > 0) {
+        const uchar* p = file.map(0, size);
+        if (p)
+            return QByteArray::fromRawData(reinterpret_cast<const char*>(p), size);
+        LOG_DEBUG("%s", qPrintable(QString("cannot map %1; reading it instead").arg(file.fileName())));
+    }
+    return file.readAll();
+}
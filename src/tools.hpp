@@ -1,7 +1,7 @@
 /*
  * This file is part of Bino, a 3D video player.
  *
- * Copyright (C) 2022, 2023, 2024, 2025
+ * Copyright (C) 2022, 2023, 2024, 2025, 2026
  * Martin Lambers <marlam@marlam.de>
  *
  * This program is free software; you can redistribute it and/or modify
@@ -22,6 +22,9 @@
 
 #include <QUrl>
 #include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QFile>
 #include <QSurfaceFormat>
 #include <QOpenGLExtraFunctions>
 
@@ -53,6 +56,15 @@ QString readFile(const char* fileName);
 #endif
 bool checkTextureAnisotropicFilterAvailability();
 
+// Desktop OpenGL only; OpenGL ES always converts to sRGB when rendering to sRGB textures
+#ifndef GL_FRAMEBUFFER_SRGB
+# define GL_FRAMEBUFFER_SRGB 0x8DB9
+#endif
+
+// Check for immutable texture storage (glTexStorage2D): part of OpenGL ES 3.0
+// and OpenGL 4.2, or available via GL_ARB_texture_storage
+bool checkTextureStorageAvailability();
+
 // Mipmap generation does not work on MacOS OpenGL 4.1, see https://github.com/marlam/bino/issues/25
 // Simply disable all use of mipmaps as a crude workaround.
 #if __APPLE__
@@ -77,3 +89,16 @@ const char* getOpenGLString(QOpenGLExtraFunctions* gl, GLenum p);
 // Shortcut to get an extension from a file name
 QString getExtension(const QString& fileName);
 QString getExtension(const QUrl& url);
+
+// Remove the least recently modified files matching the name filters from
+// the cache directory until their total size fits into the budget. Files that
+// share the base name of a removed file (e.g. metadata) are removed with it.
+// The cache directory is locked during eviction so that concurrent Bino
+// instances do not interfere. The file to keep is never removed.
+void evictFromCache(const QString& dirName, const QStringList& nameFilters, qint64 budget, const QString& keepFileName);
+
+// Get the contents of a file without copying: the file is memory-mapped, and
+// the returned data refers to the mapping, which stays valid only as long as
+// the file object exists and is open. Falls back to reading the file if it
+// cannot be mapped. The file is opened if necessary.
+QByteArray mapFile(QFile& file);
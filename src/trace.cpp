@@ -0,0 +1,183 @@
+/*
+ * This file is part of Bino, a 3D video player.
+ *
+ * Copyright (C) 2026
+ * Martin Lambers <marlam@marlam.de>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+
+#include <QCoreApplication>
+
+#include "trace.hpp"
+#include "log.hpp"
+
+
+/* Slices are collected in memory and written by a background thread in the
+ * JSON Array Format of the trace event format. That format does not require
+ * the closing bracket, so a trace is usable even if Bino crashes. */
+
+std::atomic<bool> TraceEnabledFlag(false);
+
+static const size_t traceBatchSize = 8192; // slices per write
+
+namespace {
+
+struct TraceSliceData {
+    const char* name;
+    long long begin;
+    long long duration;
+    unsigned long long frameId;
+    int threadId;
+    TraceFlow flow;
+};
+
+class TraceWriter
+{
+private:
+    std::FILE* _file;
+    long long _pid;
+    std::chrono::steady_clock::time_point _startTime;
+    std::mutex _mutex;
+    std::condition_variable _wakeup;
+    std::vector<TraceSliceData> _slices;
+    bool _stopRequested;
+    std::thread _thread;
+
+    void write(const std::vector<TraceSliceData>& slices)
+    {
+        for (const TraceSliceData& s : slices) {
+            std::fprintf(_file, "{\"name\":\"%s\",\"cat\":\"bino\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":%lld,\"tid\":%d",
+                    s.name, s.begin, s.duration, _pid, s.threadId);
+            if (s.frameId != 0)
+                std::fprintf(_file, ",\"args\":{\"frame\":%llu}", s.frameId);
+            std::fputs("},\n", _file);
+            if (s.frameId != 0 && s.flow != Trace_Flow_None) {
+                // flow events bind to the slice that encloses them
+                std::fprintf(_file, "{\"name\":\"frame\",\"cat\":\"frame\",\"ph\":\"%c\",\"id\":%llu,\"ts\":%lld,\"pid\":%lld,\"tid\":%d,\"bp\":\"e\"},\n",
+                        s.flow == Trace_Flow_Start ? 's' : 't', s.frameId, s.begin, _pid, s.threadId);
+            }
+        }
+    }
+
+    void run()
+    {
+        std::vector<TraceSliceData> slices;
+        slices.reserve(traceBatchSize);
+        for (;;) {
+            bool stopping;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _wakeup.wait_for(lock, std::chrono::seconds(1),
+                        [this]() { return _stopRequested || _slices.size() >= traceBatchSize; });
+                stopping = _stopRequested;
+                slices.swap(_slices);
+            }
+            write(slices);
+            slices.clear();
+            if (stopping)
+                break;
+        }
+    }
+
+public:
+    TraceWriter() : _file(nullptr), _pid(0), _stopRequested(false)
+    {
+    }
+
+    ~TraceWriter()
+    {
+        if (_file) {
+            TraceEnabledFlag.store(false);
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _stopRequested = true;
+                _wakeup.notify_one();
+            }
+            _thread.join();
+            std::fprintf(_file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%lld,\"args\":{\"name\":\"Bino\"}}\n]\n", _pid);
+            std::fclose(_file);
+        }
+    }
+
+    bool start(const char* fileName)
+    {
+        if (_file)
+            return false;
+        _file = std::fopen(fileName, "w");
+        if (!_file)
+            return false;
+        std::fputs("[\n", _file);
+        _pid = QCoreApplication::applicationPid();
+        _startTime = std::chrono::steady_clock::now();
+        _slices.reserve(traceBatchSize);
+        _thread = std::thread([this]() { run(); });
+        TraceEnabledFlag.store(true);
+        return true;
+    }
+
+    long long now() const
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _startTime).count();
+    }
+
+    void add(const TraceSliceData& slice)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _slices.push_back(slice);
+        if (_slices.size() == traceBatchSize)
+            _wakeup.notify_one();
+    }
+};
+
+}
+
+static TraceWriter traceWriter;
+static std::atomic<unsigned long long> traceFrameIdCounter(0);
+static std::atomic<int> traceThreadIdCounter(0);
+
+bool TraceStart(const char* fileName)
+{
+    if (!traceWriter.start(fileName)) {
+        LOG_FATAL("cannot write trace file %s", fileName);
+        return false;
+    }
+    return true;
+}
+
+unsigned long long TraceNextFrameId()
+{
+    return ++traceFrameIdCounter;
+}
+
+long long TraceNow()
+{
+    return traceWriter.now();
+}
+
+void TraceSlice(const char* name, long long begin, long long end, unsigned long long frameId, TraceFlow flow)
+{
+    if (!TraceEnabled())
+        return;
+    // small thread IDs are easier to read than the system's
+    static thread_local int threadId = ++traceThreadIdCounter;
+    traceWriter.add({ name, begin, end - begin, frameId, threadId, flow });
+}
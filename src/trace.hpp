@@ -0,0 +1,86 @@
+/*
+ * This file is part of Bino, a 3D video player.
+ *
+ * Copyright (C) 2026
+ * Martin Lambers <marlam@marlam.de>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+
+
+/* Tracing of the frame lifecycle, written as Chrome trace event JSON that
+ * can be viewed with chrome://tracing or https://ui.perfetto.dev.
+ *
+ * Each traced stage is a slice with a name and, if it belongs to a video
+ * frame, the frame ID. The slices of a frame are connected by a flow that
+ * starts when the frame arrives in the video sink.
+ *
+ * When tracing is disabled, a traced scope costs one relaxed atomic load.
+ * Names must be string literals since only the pointers are recorded. */
+
+enum TraceFlow {
+    Trace_Flow_None,    // not connected to other slices of the frame
+    Trace_Flow_Start,   // the first slice of a frame
+    Trace_Flow_Step     // a later slice of a frame
+};
+
+/* Start writing the trace to the given file; returns false on failure.
+ * The trace is completed when the program exits. */
+bool TraceStart(const char* fileName);
+
+extern std::atomic<bool> TraceEnabledFlag;
+
+inline bool TraceEnabled()
+{
+    return TraceEnabledFlag.load(std::memory_order_relaxed);
+}
+
+/* A new frame ID; IDs are never 0 */
+unsigned long long TraceNextFrameId();
+
+/* The current time in microseconds since tracing started */
+long long TraceNow();
+
+/* Record a slice. frameId 0 means that the slice belongs to no frame. */
+void TraceSlice(const char* name, long long begin, long long end, unsigned long long frameId, TraceFlow flow);
+
+/* Records a slice for the lifetime of the object */
+class TraceScope
+{
+private:
+    const char* _name;
+    unsigned long long _frameId;
+    TraceFlow _flow;
+    long long _begin;
+
+public:
+    TraceScope(const char* name, unsigned long long frameId = 0, TraceFlow flow = Trace_Flow_Step) :
+        _name(name), _frameId(frameId), _flow(flow), _begin(TraceEnabled() ? TraceNow() : -1)
+    {
+    }
+
+    ~TraceScope()
+    {
+        if (_begin >= 0)
+            TraceSlice(_name, _begin, TraceNow(), _frameId, _flow);
+    }
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(...) TraceScope TRACE_CONCAT(traceScope, __LINE__)(__VA_ARGS__)
@@ -1,7 +1,7 @@
 /*
  * This file is part of Bino, a 3D video player.
  *
- * Copyright (C) 2024
+ * Copyright (C) 2024, 2026
  * Martin Lambers <marlam@marlam.de>
  *
  * This program is free software; you can redistribute it and/or modify
@@ -19,33 +19,333 @@
  */
 
 #include <QNetworkRequest>
-#include <QGuiApplication>
+#include <QEventLoop>
+#include <QStandardPaths>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QCryptographicHash>
+#include <QDateTime>
 
 #include "urlloader.hpp"
+#include "tools.hpp"
+#include "log.hpp"
 
 
-UrlLoader::UrlLoader(const QUrl& url) : _url(url), _done(false)
+/* The disk cache holds up to three files per URL, named after the hash of
+ * the URL: the complete data (.data), an incomplete download (.part), and the
+ * ETag and Last-Modified validators of whichever of the two exists (.meta).
+ * Only HTTP(S) resources that come with at least one validator are cached. */
+
+static QString cacheDirectory;
+static const qint64 cacheSizeBudget = qint64(1024) * 1024 * 1024;
+static const int maxRetries = 2;
+
+static QString cacheDirName()
+{
+    if (cacheDirectory.isEmpty())
+        return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/downloads";
+    return cacheDirectory;
+}
+
+void UrlLoader::setCacheDirectory(const QString& dirName)
 {
+    cacheDirectory = dirName;
+}
+
+UrlLoader::UrlLoader(const QUrl& url) :
+    _url(url),
+    _reply(nullptr),
+    _timeout(30000),
+    _done(false),
+    _cancelled(false),
+    _retries(0),
+    _useCache(url.scheme() == "http" || url.scheme() == "https"),
+    _headersHandled(false),
+    _revalidating(false),
+    _notModified(false),
+    _restart(false),
+    _resumeOffset(0),
+    _received(0)
+{
+    if (_useCache) {
+        QByteArray hash = QCryptographicHash::hash(url.toEncoded(), QCryptographicHash::Sha1).toHex();
+        _cacheBaseName = cacheDirName() + '/' + QString::fromLatin1(hash);
+    }
 }
 
 UrlLoader::~UrlLoader()
 {
+    cancel();
+}
+
+QString UrlLoader::dataFileName() const
+{
+    return _cacheBaseName + ".data";
+}
+
+QString UrlLoader::partFileName() const
+{
+    return _cacheBaseName + ".part";
+}
+
+QString UrlLoader::metaFileName() const
+{
+    return _cacheBaseName + ".meta";
 }
 
-void UrlLoader::urlLoaded(QNetworkReply* reply)
+bool UrlLoader::readValidators(QByteArray& etag, QByteArray& lastModified) const
 {
-    _data = reply->readAll();
-    reply->deleteLater();
+    QFile file(metaFileName());
+    if (!file.open(QIODeviceBase::ReadOnly))
+        return false;
+    QList<QByteArray> lines = file.readAll().split('\n');
+    etag = lines.value(0);
+    lastModified = lines.value(1);
+    return !etag.isEmpty() || !lastModified.isEmpty();
+}
+
+bool UrlLoader::writeValidators(const QByteArray& etag, const QByteArray& lastModified) const
+{
+    QSaveFile file(metaFileName());
+    return file.open(QIODeviceBase::WriteOnly)
+        && file.write(etag + '\n' + lastModified + '\n') > 0
+        && file.commit();
+}
+
+void UrlLoader::sendRequest()
+{
+    _headersHandled = false;
+    _revalidating = false;
+    _notModified = false;
+    _restart = false;
+    _resumeOffset = 0;
+    _received = 0;
+
+    QNetworkRequest request(_url);
+    request.setTransferTimeout(_timeout);
+    if (_useCache) {
+        // ranges refer to the transferred bytes, so avoid transparent decompression
+        request.setRawHeader("Accept-Encoding", "identity");
+        QByteArray etag, lastModified;
+        if (readValidators(etag, lastModified)) {
+            if (QFileInfo::exists(dataFileName())) {
+                if (!etag.isEmpty())
+                    request.setRawHeader("If-None-Match", etag);
+                if (!lastModified.isEmpty())
+                    request.setRawHeader("If-Modified-Since", lastModified);
+                _revalidating = true;
+            } else {
+                qint64 partSize = QFileInfo(partFileName()).size();
+                // If-Range requires a strong validator
+                QByteArray validator = (etag.isEmpty() || etag.startsWith("W/") ? lastModified : etag);
+                if (partSize > 0 && !validator.isEmpty()) {
+                    request.setRawHeader("Range", "bytes=" + QByteArray::number(partSize) + '-');
+                    request.setRawHeader("If-Range", validator);
+                    _resumeOffset = partSize;
+                }
+            }
+        }
+    }
+    LOG_DEBUG("%s", qPrintable(QString("UrlLoader: requesting %1%2").arg(_url.toString())
+                .arg(_revalidating ? " (revalidating cache)"
+                    : _resumeOffset > 0 ? QString(" (resuming at %1)").arg(_resumeOffset)
+                    : QString())));
+    _reply = _netAccMgr.get(request);
+    connect(_reply, SIGNAL(readyRead()), this, SLOT(replyReadyRead()));
+    connect(_reply, SIGNAL(downloadProgress(qint64, qint64)), this, SLOT(replyDownloadProgress(qint64, qint64)));
+    connect(_reply, SIGNAL(finished()), this, SLOT(replyFinished()));
+}
+
+void UrlLoader::handleHeaders()
+{
+    if (_headersHandled)
+        return;
+    _headersHandled = true;
+    if (!_useCache)
+        return;
+
+    int status = _reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status == 304 && _revalidating) {
+        _notModified = true;
+        return;
+    }
+    if (status == 206 && _resumeOffset > 0) {
+        QByteArray expectedRange = "bytes " + QByteArray::number(_resumeOffset) + '-';
+        if (_reply->rawHeader("Content-Range").startsWith(expectedRange)) {
+            _partFile.setFileName(partFileName());
+            if (_partFile.open(QIODeviceBase::WriteOnly | QIODeviceBase::Append))
+                return;
+        }
+        LOG_DEBUG("%s", qPrintable(QString("UrlLoader: %1: cannot resume; restarting").arg(_url.toString())));
+        QFile::remove(partFileName());
+        QFile::remove(metaFileName());
+        _restart = true;
+        _reply->abort();
+        return;
+    }
+
+    // A complete transfer: this replaces whatever is in the cache
+    _resumeOffset = 0;
+    if (status != 200)
+        return;
+    QFile::remove(dataFileName());
+    QFile::remove(partFileName());
+    QByteArray etag = _reply->rawHeader("ETag");
+    QByteArray lastModified = _reply->rawHeader("Last-Modified");
+    if (etag.isEmpty() && lastModified.isEmpty()) {
+        QFile::remove(metaFileName());
+        return;
+    }
+    _partFile.setFileName(partFileName());
+    if (!QDir().mkpath(cacheDirName())
+            || !writeValidators(etag, lastModified)
+            || !_partFile.open(QIODeviceBase::WriteOnly | QIODeviceBase::Truncate)) {
+        LOG_DEBUG("%s", qPrintable(QString("UrlLoader: %1: cannot write to cache directory %2").arg(_url.toString()).arg(cacheDirName())));
+    }
+}
+
+void UrlLoader::replyReadyRead()
+{
+    QNetworkReply* reply = _reply;
+    if (sender() != reply)
+        return;
+    handleHeaders();
+    if (_reply != reply || _restart)
+        return;
+    QByteArray chunk = _reply->readAll();
+    _received += chunk.size();
+    if (_partFile.isOpen()) {
+        if (_partFile.write(chunk) != chunk.size()) {
+            // continue in memory
+            LOG_DEBUG("%s", qPrintable(QString("UrlLoader: %1: cannot write to cache file").arg(_url.toString())));
+            _partFile.close();
+            if (_partFile.open(QIODeviceBase::ReadOnly))
+                _data = _partFile.read(_resumeOffset + _received - chunk.size());
+            _partFile.close();
+            _partFile.remove();
+            QFile::remove(metaFileName());
+            _data.append(chunk);
+        }
+    } else if (!_notModified) {
+        _data.append(chunk);
+    }
+}
+
+void UrlLoader::replyDownloadProgress(qint64 bytesReceived, qint64 bytesTotal)
+{
+    if (sender() != _reply || _notModified || _restart)
+        return;
+    emit progress(_resumeOffset + bytesReceived, bytesTotal < 0 ? -1 : _resumeOffset + bytesTotal);
+}
+
+bool UrlLoader::readCachedData()
+{
+    {
+        // mark as recently used
+        QFile file(dataFileName());
+        if (!file.open(QIODeviceBase::ReadWrite))
+            return false;
+        file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    }
+    // Map the file instead of reading it. Cache files are replaced by renaming,
+    // never rewritten in place, so the mapping stays valid.
+    _localFile.close();
+    _localFile.setFileName(dataFileName());
+    _data = mapFile(_localFile);
+    return _localFile.isOpen() && _localFile.error() == QFileDevice::NoError;
+}
+
+void UrlLoader::replyFinished()
+{
+    if (sender() != _reply)
+        return;
+    bool ok = (_reply->error() == QNetworkReply::NoError);
+    if (ok)
+        handleHeaders();
+    // keep what arrived before an error, too, so that a resumed request starts after it
+    if (_headersHandled && _reply->bytesAvailable() > 0)
+        replyReadyRead();
+    if (!ok) {
+        LOG_DEBUG("%s", qPrintable(QString("UrlLoader: %1: %2").arg(_url.toString()).arg(_reply->errorString())));
+    }
+    _reply->deleteLater();
+    _reply = nullptr;
+    bool wroteToCache = _partFile.isOpen();
+    _partFile.close();
+
+    if (_restart && !_cancelled) {
+        sendRequest();
+        return;
+    }
+    if (ok && _notModified) {
+        LOG_DEBUG("%s", qPrintable(QString("UrlLoader: %1 is unchanged in cache").arg(_url.toString())));
+        ok = readCachedData();
+    } else if (ok && wroteToCache) {
+        QFile::remove(dataFileName());
+        ok = QFile::rename(partFileName(), dataFileName()) && readCachedData();
+        if (ok)
+            evictFromCache(cacheDirName(), { "*.data", "*.part" }, cacheSizeBudget, dataFileName());
+    } else if (!ok && !_cancelled) {
+        if (wroteToCache && _received > 0 && _retries < maxRetries) {
+            // the partial data stays in the cache; resume with a range request
+            _retries++;
+            sendRequest();
+            return;
+        }
+        if (_revalidating && readCachedData()) {
+            LOG_DEBUG("%s", qPrintable(QString("UrlLoader: %1: using cached data that could not be revalidated").arg(_url.toString())));
+            ok = true;
+        }
+    }
+    if (!ok)
+        _data.clear();
     _done = true;
+    emit finished();
+}
+
+void UrlLoader::start(int timeoutMilliseconds)
+{
+    if (_reply || _done)
+        return;
+    if (_url.isLocalFile()) {
+        // fast path without copying; finished() is still emitted asynchronously
+        _localFile.setFileName(_url.toLocalFile());
+        _data = mapFile(_localFile);
+        if (_data.isEmpty())
+            LOG_DEBUG("%s", qPrintable(QString("UrlLoader: %1: %2").arg(_url.toString()).arg(_localFile.errorString())));
+        _done = true;
+        QMetaObject::invokeMethod(this, [this]() { emit finished(); }, Qt::QueuedConnection);
+        return;
+    }
+    _timeout = timeoutMilliseconds;
+    sendRequest();
+}
+
+void UrlLoader::cancel()
+{
+    _cancelled = true;
+    if (_reply)
+        _reply->abort(); // emits finished, with an error
+}
+
+bool UrlLoader::isDone() const
+{
+    return _done;
+}
+
+const QByteArray& UrlLoader::data() const
+{
+    return _data;
 }
 
 const QByteArray& UrlLoader::load()
 {
-    connect(&_netAccMgr, SIGNAL(finished(QNetworkReply*)), this, SLOT(urlLoaded(QNetworkReply*)));
-    QNetworkRequest request(_url);
-    _netAccMgr.get(request);
-    while (!_done) {
-        QGuiApplication::processEvents();
+    start();
+    if (!_done) {
+        QEventLoop loop;
+        connect(this, SIGNAL(finished()), &loop, SLOT(quit()));
+        loop.exec();
     }
     return _data;
 }
@@ -1,7 +1,7 @@
 /*
  * This file is part of Bino, a 3D video player.
  *
- * Copyright (C) 2024
+ * Copyright (C) 2024, 2026
  * Martin Lambers <marlam@marlam.de>
  *
  * This program is free software; you can redistribute it and/or modify
@@ -21,11 +21,26 @@
 #pragma once
 
 #include <QByteArray>
+#include <QFile>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QUrl>
 
 
+/* Loads the data of a URL. The data is streamed: progress() is emitted while
+ * it arrives, and HTTP(S) downloads are written to an on-disk cache instead
+ * of being accumulated in memory.
+ *
+ * The cache is revalidated with ETag / Last-Modified on each load, so an
+ * unchanged resource is not transferred again. Incomplete downloads are kept
+ * in the cache and resumed with an HTTP Range request, both after a network
+ * error during the same load and on a later load.
+ *
+ * Local files and cache hits are not loaded at all: they are memory-mapped,
+ * and data() refers to the mapping, which is valid as long as the loader
+ * exists.
+ *
+ * See tests/urlloader-test.cpp for the expected behavior with different servers. */
 class UrlLoader : public QObject
 {
     Q_OBJECT
@@ -33,15 +48,59 @@ class UrlLoader : public QObject
 private:
     QUrl _url;
     QNetworkAccessManager _netAccMgr;
+    QNetworkReply* _reply;
+    int _timeout;
     QByteArray _data;
+    QFile _localFile;   // the mapped local file or cache file
     bool _done;
+    bool _cancelled;
+    int _retries;
+    // disk cache state for the current request
+    bool _useCache;
+    QString _cacheBaseName;
+    QFile _partFile;
+    bool _headersHandled;
+    bool _revalidating;     // the request is conditional on the complete cached copy
+    bool _notModified;      // the complete cached copy is still valid
+    bool _restart;          // the reply was aborted to restart without a range
+    qint64 _resumeOffset;   // the size of the partial cached copy that is being resumed
+    qint64 _received;
+
+    QString dataFileName() const;
+    QString partFileName() const;
+    QString metaFileName() const;
+    bool readValidators(QByteArray& etag, QByteArray& lastModified) const;
+    bool writeValidators(const QByteArray& etag, const QByteArray& lastModified) const;
+    void sendRequest();
+    void handleHeaders();
+    bool readCachedData();
+    void finish(bool success);
 
 private slots:
-    void urlLoaded(QNetworkReply* reply);
+    void replyReadyRead();
+    void replyDownloadProgress(qint64 bytesReceived, qint64 bytesTotal);
+    void replyFinished();
 
 public:
     UrlLoader(const QUrl& url);
     virtual ~UrlLoader();
 
+    /* Set the directory of the disk cache, e.g. for tests.
+     * The default is a subdirectory of the standard cache location. */
+    static void setCacheDirectory(const QString& dirName);
+
+    // Asynchronous interface: start(), then wait for finished().
+    // The data is empty if loading failed, timed out, or was cancelled.
+    void start(int timeoutMilliseconds = 30000);
+    void cancel();
+    bool isDone() const;
+    const QByteArray& data() const;
+
+    // Synchronous interface: waits in a local event loop
     const QByteArray& load();
+
+signals:
+    // bytesTotal is -1 if unknown
+    void progress(qint64 bytesReceived, qint64 bytesTotal);
+    void finished();
 };
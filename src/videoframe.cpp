@@ -19,10 +19,11 @@
  */
 
 #include "videoframe.hpp"
+#include "trace.hpp"
 #include "log.hpp"
 
 
-VideoFrame::VideoFrame() : fallback(Fallback_Minimal)
+VideoFrame::VideoFrame() : frameId(0), fallback(Fallback_Minimal)
 {
     update(Input_Unknown, Surround_Unknown, QVideoFrame(), false);
 }
@@ -138,6 +139,7 @@ void VideoFrame::update(InputMode im, SurroundMode sm, const QVideoFrame& frame,
             pixelFormat = QVideoFrameFormat::pixelFormatFromImageFormat(QImage::Format_RGB32);
             colorRangeSmall = false;
             colorSpace = CS_AdobeRgb;
+            TRACE_SCOPE("toImage", frameId);
             image = qframe.toImage();
             image.convertTo(QImage::Format_RGB32);
         } else {
@@ -192,7 +194,10 @@ void VideoFrame::update(InputMode im, SurroundMode sm, const QVideoFrame& frame,
                 masteringWhite = linearToHLG(qframe.surfaceFormat().maxLuminance() / 100.0f);
                 break;
             }
-            qframe.map(QVideoFrame::ReadOnly);
+            {
+                TRACE_SCOPE("map", frameId);
+                qframe.map(QVideoFrame::ReadOnly);
+            }
             planeCount = qframe.planeCount();
             for (int p = 0; p < planeCount; p++) {
                 bytesPerLine[p] = qframe.bytesPerLine(p);
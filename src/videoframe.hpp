@@ -72,6 +72,8 @@ public:
 
     /* This is a shallow copy of the original QVideoFrame: */
     QVideoFrame qframe;
+    /* The ID of this frame for tracing, or 0 if tracing is disabled: */
+    unsigned long long frameId;
     /* The input mode of this frame: */
     InputMode inputMode;
     /* The surround mode of this frame: */
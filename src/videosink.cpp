@@ -1,7 +1,7 @@
 /*
  * This file is part of Bino, a 3D video player.
  *
- * Copyright (C) 2022, 2023, 2024, 2025
+ * Copyright (C) 2022, 2023, 2024, 2025, 2026
  * Martin Lambers <marlam@marlam.de>
  *
  * This program is free software; you can redistribute it and/or modify
@@ -21,6 +21,7 @@
 #include <QUrl>
 
 #include "videosink.hpp"
+#include "trace.hpp"
 #include "log.hpp"
 
 
@@ -74,6 +75,8 @@ void VideoSink::processNewFrame(const QVideoFrame& frame)
         LOG_FIREHOSE("video sink gets a valid frame");
         lastFrameWasValid = true;
     }
+    unsigned long long frameId = (TraceEnabled() && frame.isValid() ? TraceNextFrameId() : 0);
+    TRACE_SCOPE("frame arrival", frameId, Trace_Flow_Start);
 
     bool updateExtFrame;
     if (inputMode == Input_Alternating_LR || inputMode == Input_Alternating_RL) {
@@ -92,14 +95,18 @@ void VideoSink::processNewFrame(const QVideoFrame& frame)
         needExtFrame = false;
     }
     if (updateExtFrame) {
+        this->extFrame->frameId = frameId;
         this->extFrame->update(inputMode, surroundMode, frame, frameCounter == 0);
     } else {
+        this->frame->frameId = frameId;
         this->frame->update(inputMode, surroundMode, frame, frameCounter == 0);
         this->extFrame->invalidate();
     }
     if (!needExtFrame) {
         LOG_FIREHOSE("video sink signals that new frame is complete");
         *frameIsNew = true;
+        if (frame.isValid() && frame.startTime() >= 0)
+            emit newVideoFrameTime(frame.startTime());
         emit newVideoFrame();
     }
     frameCounter++;
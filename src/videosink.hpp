@@ -1,7 +1,7 @@
 /*
  * This file is part of Bino, a 3D video player.
  *
- * Copyright (C) 2022, 2023, 2024, 2025
+ * Copyright (C) 2022, 2023, 2024, 2025, 2026
  * Martin Lambers <marlam@marlam.de>
  *
  * This program is free software; you can redistribute it and/or modify
@@ -50,5 +50,6 @@ public Q_SLOTS:
     void processNewFrame(const QVideoFrame& frame);
 
 signals:
+    void newVideoFrameTime(qint64 microseconds); // media time of the new frame, if known; emitted before newVideoFrame()
     void newVideoFrame();
 };
@@ -26,6 +26,7 @@
 #include "widget.hpp"
 #include "playlist.hpp"
 #include "tools.hpp"
+#include "trace.hpp"
 #include "log.hpp"
 
 /* These might not be defined on Mac OS. Use crude replacements. */
@@ -61,11 +62,18 @@ Widget::Widget(OutputMode outputMode, float surroundVerticalFOV, QWidget* parent
     QSize maxSize = 0.75f * screenSize;
     _sizeHint = SizeBase.scaled(maxSize, Qt::KeepAspectRatio);
     connect(Bino::instance(), &Bino::newVideoFrame, [=]() { update(); });
+    connect(Bino::instance(), &Bino::renderRequested, [=]() { update(); });
     connect(Bino::instance(), &Bino::toggleFullscreen, [=]() { emit toggleFullscreen(); });
     connect(Playlist::instance(), SIGNAL(mediaChanged(PlaylistEntry)), this, SLOT(mediaChanged(PlaylistEntry)));
     _updateTimer.setSingleShot(true);
     _updateTimer.setTimerType(Qt::CoarseTimer);
     connect(&_updateTimer, SIGNAL(timeout()), this, SLOT(update()));
+    connect(this, &QOpenGLWidget::frameSwapped, [=]() {
+            if (TraceEnabled()) {
+                long long now = TraceNow();
+                TraceSlice("swap", now, now, Bino::instance()->frameId(), Trace_Flow_Step);
+            }
+            });
     setFocus();
 }
 
@@ -349,6 +357,7 @@ void Widget::paintGL()
     }
 
     // Put the views on screen in the current mode
+    TRACE_SCOPE("display composition", Bino::instance()->frameId());
     glViewport(0, 0, width, height);
     glDisable(GL_DEPTH_TEST);
     float relWidth = 1.0f;
@@ -0,0 +1,181 @@
+/*
+ * This file is part of Bino, a 3D video player.
+ *
+ * Copyright (C) 2026
+ * Martin Lambers <marlam@marlam.de>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+
+#include <QTest>
+#include <QProcess>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QNetworkProxy>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+
+/* Synchronized playback of headless Bino instances on localhost. The Bino
+ * executable and ffmpeg (to generate the test videos) are given in the
+ * environment variables BINO_EXECUTABLE and FFMPEG_EXECUTABLE. */
+
+static quint16 freePort()
+{
+    QTcpServer server;
+    server.listen(QHostAddress::LocalHost);
+    return server.serverPort();
+}
+
+class Instance : public QObject
+{
+    Q_OBJECT
+
+public:
+    QProcess process;
+    quint16 port;
+    QTcpSocket control;
+    QJsonObject lastMedia;      // last reply to 'query media'
+    int goodSkewCount;          // consecutive stats events with a skew below one frame
+
+    Instance(const QStringList& arguments) :
+        port(freePort()),
+        goodSkewCount(0)
+    {
+        process.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+        process.start(qEnvironmentVariable("BINO_EXECUTABLE"), QStringList {
+                "--headless", "--headless-output", QProcess::nullDevice(), "--headless-size", "64x64",
+                "--control-tcp", QString("127.0.0.1:%1").arg(port) } + arguments);
+        connect(&control, &QTcpSocket::readyRead, this, [this]() { readReplies(); });
+    }
+
+    ~Instance()
+    {
+        if (control.state() == QAbstractSocket::ConnectedState) {
+            send("quit");
+            control.waitForBytesWritten(1000);
+        }
+        if (!process.waitForFinished(5000)) {
+            process.kill();
+            process.waitForFinished();
+        }
+    }
+
+    bool connectControl()
+    {
+        // the instance listens only after its startup
+        for (int i = 0; i < 100; i++) {
+            control.connectToHost(QHostAddress::LocalHost, port);
+            if (control.waitForConnected(1000))
+                return true;
+            control.abort();
+            QTest::qWait(100);
+        }
+        return false;
+    }
+
+    void send(const QByteArray& cmd)
+    {
+        control.write(cmd + '\n');
+    }
+
+private:
+    void readReplies()
+    {
+        while (control.canReadLine()) {
+            QJsonObject o = QJsonDocument::fromJson(control.readLine()).object();
+            if (o.value("reply").toString() == "media") {
+                lastMedia = o;
+            } else if (o.value("event").toString() == "stats") {
+                // in sync means within one frame of the 25 fps test videos
+                if (o.contains("sync_skew_ms") && std::abs(o.value("sync_skew_ms").toDouble()) < 40.0)
+                    goodSkewCount++;
+                else
+                    goodSkewCount = 0;
+            }
+        }
+    }
+};
+
+class SyncTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    QTemporaryDir* _mediaDir = nullptr;
+
+    QString media(const QString& name) const
+    {
+        return _mediaDir->filePath(name);
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QNetworkProxy::setApplicationProxy(QNetworkProxy::NoProxy);
+        QString ffmpeg = qEnvironmentVariable("FFMPEG_EXECUTABLE");
+        if (qEnvironmentVariable("BINO_EXECUTABLE").isEmpty() || ffmpeg.isEmpty() || ffmpeg.endsWith("NOTFOUND"))
+            QSKIP("needs BINO_EXECUTABLE and FFMPEG_EXECUTABLE");
+        _mediaDir = new QTemporaryDir;
+        QVERIFY(_mediaDir->isValid());
+        for (const QString& name : { QString("a.mp4"), QString("b.mp4") }) {
+            QProcess p;
+            p.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+            p.start(ffmpeg, { "-v", "error", "-f", "lavfi",
+                    "-i", (name == "a.mp4" ? "testsrc=duration=60:size=160x120:rate=25"
+                                           : "testsrc2=duration=60:size=160x120:rate=25"),
+                    "-c:v", "mpeg4", "-y", media(name) });
+            QVERIFY(p.waitForFinished(60000));
+            QCOMPARE(p.exitCode(), 0);
+        }
+    }
+
+    void cleanupTestCase()
+    {
+        delete _mediaDir;
+    }
+
+    void followPosition()
+    {
+        Instance master({ media("a.mp4") });
+        QVERIFY(master.connectControl());
+        // start late, so that the follower has to catch up
+        QTest::qWait(2000);
+        Instance follower({ "--sync-follower", QString("127.0.0.1:%1").arg(master.port), media("a.mp4") });
+        QVERIFY(follower.connectControl());
+        follower.send("subscribe stats 200");
+        QTRY_VERIFY_WITH_TIMEOUT(follower.goodSkewCount >= 5, 30000);
+    }
+
+    void followPlaylistEntry()
+    {
+        Instance master({ media("a.mp4"), media("b.mp4") });
+        QVERIFY(master.connectControl());
+        Instance follower({ "--sync-follower", QString("127.0.0.1:%1").arg(master.port), media("a.mp4"), media("b.mp4") });
+        QVERIFY(follower.connectControl());
+        follower.send("subscribe stats 200");
+        QTRY_VERIFY_WITH_TIMEOUT(follower.goodSkewCount >= 5, 30000);
+        master.send("playlist-next");
+        QTRY_VERIFY_WITH_TIMEOUT((follower.send("query media"), follower.lastMedia.value("playlist_index").toInt() == 1), 30000);
+        // the skew is measured again once both play the same entry
+        follower.goodSkewCount = 0;
+        QTRY_VERIFY_WITH_TIMEOUT(follower.goodSkewCount >= 5, 30000);
+    }
+};
+
+QTEST_GUILESS_MAIN(SyncTest)
+#include "sync-test.moc"
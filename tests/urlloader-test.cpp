@@ -0,0 +1,307 @@
+/*
+ * This file is part of Bino, a 3D video player.
+ *
+ * Copyright (C) 2026
+ * Martin Lambers <marlam@marlam.de>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QTest>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QNetworkProxy>
+#include <QMap>
+
+#include "urlloader.hpp"
+
+
+/* A stand-in HTTP server on localhost that serves one resource and can be
+ * told to ignore conditional and range requests and to cut off transfers. */
+
+struct StandInRequest
+{
+    QByteArray method;
+    QByteArray path;
+    QMap<QByteArray, QByteArray> headers; // names are lower case
+};
+
+class StandInServer : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    QByteArray body;
+    QByteArray etag;            // no ETag header if empty
+    QByteArray lastModified;    // no Last-Modified header if empty
+    bool honorConditional;      // answer If-None-Match / If-Modified-Since with 304
+    bool honorRange;            // answer Range with 206
+    qint64 truncateAfter;       // close the connection after this many body bytes; -1 = never
+    QList<StandInRequest> requests;
+    qint64 bodyBytesSent;
+
+    StandInServer() :
+        honorConditional(true),
+        honorRange(true),
+        truncateAfter(-1),
+        bodyBytesSent(0)
+    {
+        connect(this, &QTcpServer::newConnection, this, &StandInServer::acceptConnections);
+        listen(QHostAddress::LocalHost);
+    }
+
+    QUrl url() const
+    {
+        return QUrl(QString("http://127.0.0.1:%1/resource").arg(serverPort()));
+    }
+
+private:
+    void acceptConnections()
+    {
+        while (QTcpSocket* socket = nextPendingConnection()) {
+            connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { readRequest(socket); });
+        }
+    }
+
+    void readRequest(QTcpSocket* socket)
+    {
+        QByteArray buffer = socket->property("requestBuffer").toByteArray() + socket->readAll();
+        int end = buffer.indexOf("\r\n\r\n");
+        if (end < 0) {
+            socket->setProperty("requestBuffer", buffer);
+            return;
+        }
+        socket->setProperty("requestBuffer", QByteArray());
+        StandInRequest request;
+        QList<QByteArray> lines = buffer.left(end).split('\n');
+        QList<QByteArray> requestLine = lines.value(0).trimmed().split(' ');
+        request.method = requestLine.value(0);
+        request.path = requestLine.value(1);
+        for (qsizetype i = 1; i < lines.size(); i++) {
+            int colon = lines[i].indexOf(':');
+            if (colon > 0)
+                request.headers.insert(lines[i].left(colon).trimmed().toLower(), lines[i].mid(colon + 1).trimmed());
+        }
+        requests.append(request);
+        respond(socket, request);
+    }
+
+    void respond(QTcpSocket* socket, const StandInRequest& request)
+    {
+        QByteArray status = "200 OK";
+        QByteArray content = body;
+        QByteArray extraHeaders;
+        QByteArray ifNoneMatch = request.headers.value("if-none-match");
+        QByteArray ifModifiedSince = request.headers.value("if-modified-since");
+        QByteArray range = request.headers.value("range");
+        QByteArray ifRange = request.headers.value("if-range");
+        if (honorConditional
+                && ((!ifNoneMatch.isEmpty() && ifNoneMatch == etag)
+                    || (ifNoneMatch.isEmpty() && !ifModifiedSince.isEmpty() && ifModifiedSince == lastModified))) {
+            status = "304 Not Modified";
+            content.clear();
+        } else if (honorRange && range.startsWith("bytes=") && range.endsWith('-')
+                && (ifRange.isEmpty() || ifRange == etag || ifRange == lastModified)) {
+            qint64 offset = range.mid(6, range.size() - 7).toLongLong();
+            if (offset > 0 && offset < body.size()) {
+                status = "206 Partial Content";
+                content = body.mid(offset);
+                extraHeaders = "Content-Range: bytes " + QByteArray::number(offset) + '-'
+                    + QByteArray::number(body.size() - 1) + '/' + QByteArray::number(body.size()) + "\r\n";
+            }
+        }
+        QByteArray header = "HTTP/1.1 " + status + "\r\n";
+        if (!etag.isEmpty())
+            header += "ETag: " + etag + "\r\n";
+        if (!lastModified.isEmpty())
+            header += "Last-Modified: " + lastModified + "\r\n";
+        header += extraHeaders;
+        header += "Connection: close\r\n";
+        if (!status.startsWith("304")) {
+            header += "Content-Type: application/octet-stream\r\n";
+            header += "Content-Length: " + QByteArray::number(content.size()) + "\r\n";
+        }
+        header += "\r\n";
+        if (truncateAfter >= 0 && content.size() > truncateAfter)
+            content.truncate(truncateAfter);
+        bodyBytesSent += content.size();
+        socket->write(header + content);
+        socket->disconnectFromHost();
+    }
+};
+
+class UrlLoaderTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    QTemporaryDir* _cacheDir;
+
+    static QByteArray testData(int size, char seed)
+    {
+        QByteArray data(size, Qt::Uninitialized);
+        for (int i = 0; i < size; i++)
+            data[i] = char((i * 7 + seed) % 251);
+        return data;
+    }
+
+    static QByteArray load(const QUrl& url)
+    {
+        UrlLoader loader(url);
+        const QByteArray& data = loader.load();
+        // deep copy, since the data may refer to a mapping that ends with the loader
+        return QByteArray(data.constData(), data.size());
+    }
+
+private slots:
+    void initTestCase()
+    {
+        // the stand-in server is on localhost
+        QNetworkProxy::setApplicationProxy(QNetworkProxy::NoProxy);
+    }
+
+    void init()
+    {
+        _cacheDir = new QTemporaryDir;
+        QVERIFY(_cacheDir->isValid());
+        UrlLoader::setCacheDirectory(_cacheDir->path());
+    }
+
+    void cleanup()
+    {
+        delete _cacheDir;
+        _cacheDir = nullptr;
+    }
+
+    void revalidateWithETag()
+    {
+        StandInServer server;
+        server.body = testData(100000, 1);
+        server.etag = "\"v1\"";
+        QCOMPARE(load(server.url()), server.body);
+        QCOMPARE(load(server.url()), server.body);
+        QCOMPARE(server.requests.size(), qsizetype(2));
+        QVERIFY(!server.requests[0].headers.contains("if-none-match"));
+        QCOMPARE(server.requests[1].headers.value("if-none-match"), server.etag);
+        // the second load was answered with 304 from the cache
+        QCOMPARE(server.bodyBytesSent, qint64(server.body.size()));
+    }
+
+    void revalidateWithLastModified()
+    {
+        StandInServer server;
+        server.body = testData(100000, 2);
+        server.lastModified = "Wed, 21 Oct 2015 07:28:00 GMT";
+        QCOMPARE(load(server.url()), server.body);
+        QCOMPARE(load(server.url()), server.body);
+        QCOMPARE(server.requests.size(), qsizetype(2));
+        QVERIFY(!server.requests[1].headers.contains("if-none-match"));
+        QCOMPARE(server.requests[1].headers.value("if-modified-since"), server.lastModified);
+        QCOMPARE(server.bodyBytesSent, qint64(server.body.size()));
+    }
+
+    void changedResource()
+    {
+        StandInServer server;
+        server.body = testData(100000, 3);
+        server.etag = "\"v1\"";
+        QCOMPARE(load(server.url()), server.body);
+        server.body = testData(50000, 4);
+        server.etag = "\"v2\"";
+        QCOMPARE(load(server.url()), server.body);
+        QCOMPARE(load(server.url()), server.body);
+        QCOMPARE(server.requests.size(), qsizetype(3));
+        QCOMPARE(server.requests[1].headers.value("if-none-match"), QByteArray("\"v1\""));
+        QCOMPARE(server.requests[2].headers.value("if-none-match"), QByteArray("\"v2\""));
+        QCOMPARE(server.bodyBytesSent, qint64(100000 + 50000));
+    }
+
+    void uncachedWithoutValidators()
+    {
+        StandInServer server;
+        server.body = testData(10000, 5);
+        QCOMPARE(load(server.url()), server.body);
+        QCOMPARE(load(server.url()), server.body);
+        QCOMPARE(server.requests.size(), qsizetype(2));
+        QVERIFY(!server.requests[1].headers.contains("if-none-match"));
+        QVERIFY(!server.requests[1].headers.contains("if-modified-since"));
+        QVERIFY(!server.requests[1].headers.contains("range"));
+    }
+
+    void resumeAfterTruncatedTransfer()
+    {
+        StandInServer server;
+        server.body = testData(100000, 6);
+        server.etag = "\"v1\"";
+        server.truncateAfter = 30000;
+        // the first load retries twice with range requests, then gives up
+        QVERIFY(load(server.url()).isEmpty());
+        QCOMPARE(server.requests.size(), qsizetype(3));
+        QVERIFY(!server.requests[0].headers.contains("range"));
+        QCOMPARE(server.requests[1].headers.value("range"), QByteArray("bytes=30000-"));
+        QCOMPARE(server.requests[1].headers.value("if-range"), server.etag);
+        QCOMPARE(server.requests[2].headers.value("range"), QByteArray("bytes=60000-"));
+        // a later load resumes where the first one stopped
+        server.truncateAfter = -1;
+        QCOMPARE(load(server.url()), server.body);
+        QCOMPARE(server.requests.size(), qsizetype(4));
+        QCOMPARE(server.requests[3].headers.value("range"), QByteArray("bytes=90000-"));
+        QCOMPARE(server.bodyBytesSent, qint64(server.body.size()));
+        // and the result is cached
+        QCOMPARE(load(server.url()), server.body);
+        QCOMPARE(server.requests.size(), qsizetype(5));
+        QCOMPARE(server.requests[4].headers.value("if-none-match"), server.etag);
+        QCOMPARE(server.bodyBytesSent, qint64(server.body.size()));
+    }
+
+    void resumeWithChangedResource()
+    {
+        StandInServer server;
+        server.body = testData(100000, 7);
+        server.etag = "\"v1\"";
+        server.truncateAfter = 30000;
+        QVERIFY(load(server.url()).isEmpty());
+        // If-Range does not match anymore, so the server sends everything
+        server.body = testData(80000, 8);
+        server.etag = "\"v2\"";
+        server.truncateAfter = -1;
+        QCOMPARE(load(server.url()), server.body);
+        QCOMPARE(server.requests.last().headers.value("if-range"), QByteArray("\"v1\""));
+    }
+
+    void serverIgnoresRange()
+    {
+        StandInServer server;
+        server.body = testData(100000, 9);
+        server.etag = "\"v1\"";
+        server.honorRange = false;
+        server.truncateAfter = 30000;
+        QVERIFY(load(server.url()).isEmpty());
+        QVERIFY(server.requests.size() >= 2);
+        QCOMPARE(server.requests[1].headers.value("range"), QByteArray("bytes=30000-"));
+        // the full response to a range request replaces the partial data
+        server.truncateAfter = -1;
+        QCOMPARE(load(server.url()), server.body);
+        QVERIFY(server.requests.last().headers.contains("range"));
+        qint64 sent = server.bodyBytesSent;
+        QCOMPARE(load(server.url()), server.body);
+        QCOMPARE(server.requests.last().headers.value("if-none-match"), server.etag);
+        QCOMPARE(server.bodyBytesSent, sent);
+    }
+};
+
+QTEST_GUILESS_MAIN(UrlLoaderTest)
+#include "urlloader-test.moc"